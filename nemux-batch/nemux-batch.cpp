@@ -0,0 +1,230 @@
+/*
+ * nemux-batch.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: scorder
+ */
+
+#include <iostream>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <memory>
+#include <stdexcept>
+
+#include "NesFile.h"
+#include "Machine.h"
+#include "Movie.h"
+#include "ThreadPool.h"
+
+void usage() {
+    std::cout << "NeMux headless batch runner" << std::endl;
+    std::cout << "Usage: nemux-batch [options] manifest" << std::endl;
+    std::cout << "Parameters:" << std::endl;
+    std::cout << "    manifest   Text file with one job per line: nesfile movie frames" << std::endl;
+    std::cout << "               nesfile - runs the ROM the movie was recorded with," << std::endl;
+    std::cout << "               movie is a nemux-vis -record movie, a legacy replay or - for no input," << std::endl;
+    std::cout << "               frames 0 runs until the movie ends," << std::endl;
+    std::cout << "               relative paths start at the manifest directory," << std::endl;
+    std::cout << "               lines starting with # are ignored" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "    -threads N       Worker threads (default one per hardware thread)" << std::endl;
+    std::cout << "    -rate N          Audio sample rate hashed (default 48000)" << std::endl;
+    std::cout << "    -out FILE        Write the results to FILE instead of the standard output" << std::endl;
+    std::cout << "    -help            Print this help message" << std::endl;
+}
+
+void error(const std::string & message) {
+    std::cout << message << std::endl;
+    std::cout << std::endl;
+    usage();
+}
+
+struct Job {
+    std::string Rom;
+    std::string Movie;
+    size_t Frames = 0;
+
+    // Results
+    bool Done = false;
+    std::string Error;
+    size_t FramesRun = 0;
+    uint64_t FrameHash = 0;
+    uint64_t RamHash = 0;
+    uint64_t AudioHash = 0;
+    double Seconds = 0.0;
+};
+
+// Runs one job on the console built for its mapper
+struct BatchSession {
+    Job & job;
+    movie::Player * player;
+
+    BatchSession(Job & job, movie::Player * player) : job(job), player(player) {}
+
+    template <class Console_t>
+    void operator()(Console_t & nes) {
+        // Pictures and audio are hashed over every frame, a run that
+        // diverges and comes back still reports other hashes
+        uint64_t frames = 0;
+        uint64_t audio = 0;
+        std::vector<int16_t> samples;
+        bool playing = player != nullptr;
+        while (job.Frames == 0 ? playing : job.FramesRun < job.Frames) {
+            nes.RunUntilFrame();
+            ++job.FramesRun;
+            const auto picture = movie::HashOf(nes.ppu.Screen);
+            frames = Xxh64::Of(&picture, sizeof(picture), frames);
+            samples.resize(nes.Audio.SamplesAvailable());
+            nes.Audio.ReadSamples(samples.data(), samples.size());
+            audio = Xxh64::Of(samples, audio);
+            if (playing) playing = player->PlayFrame(nes);
+        }
+        job.FrameHash = frames;
+        job.RamHash = Xxh64::Of(nes.cpumap.RAM);
+        job.AudioHash = audio;
+    }
+};
+
+std::string Directory(const std::string & path) {
+    const auto slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+std::string Resolve(const std::string & directory, const std::string & path) {
+    const bool absolute = !path.empty() && (path[0] == '/' || path[0] == '\\' || path.find(':') != std::string::npos);
+    return absolute ? path : directory + path;
+}
+
+std::vector<Job> ReadManifest(const std::string & path) {
+    std::ifstream manifest(path);
+    if (!manifest) throw std::runtime_error("Cannot open manifest " + path);
+    const auto directory = Directory(path);
+    std::vector<Job> jobs;
+    std::string line;
+    size_t number = 0;
+    while (std::getline(manifest, line)) {
+        ++number;
+        std::istringstream fields(line);
+        std::string rom;
+        if (!(fields >> rom) || rom[0] == '#') continue;
+        Job job;
+        if (!(fields >> job.Movie >> job.Frames)) {
+            throw std::runtime_error("Malformed manifest line " + std::to_string(number));
+        }
+        if (job.Movie == "-" && (job.Frames == 0 || rom == "-")) {
+            throw std::runtime_error("Manifest line " + std::to_string(number) + " needs a movie");
+        }
+        job.Rom = rom == "-" ? rom : Resolve(directory, rom);
+        if (job.Movie != "-") job.Movie = Resolve(directory, job.Movie);
+        jobs.push_back(job);
+    }
+    return jobs;
+}
+
+void Run(Job & job, const size_t sampleRate) {
+    const auto start = std::chrono::steady_clock::now();
+    try {
+        std::ifstream movieFile;
+        std::unique_ptr<movie::Player> player;
+        if (job.Movie != "-") {
+            movieFile.open(job.Movie, std::ios::binary);
+            if (!movieFile) throw std::runtime_error("Cannot open " + job.Movie);
+            player.reset(new movie::Player(movieFile));
+            auto recorded = player->MovieHeader.RomPath;
+            std::replace(recorded.begin(), recorded.end(), '\\', '/');
+            if (job.Rom == "-") job.Rom = Resolve(Directory(job.Movie), recorded);
+        }
+
+        std::ifstream file(job.Rom, std::ios::binary);
+        if (!file) throw std::runtime_error("Cannot open " + job.Rom);
+        NesFile rom(file);
+        BatchSession session(job, player.get());
+        WithConsole(rom, session, sampleRate);
+        job.Done = true;
+    }
+    catch (const std::exception & e) {
+        job.Error = e.what();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    job.Seconds = elapsed.count();
+}
+
+void Report(std::ostream & out, const std::vector<Job> & jobs) {
+    out << "job\trom\tmovie\tframes\tframe_hash\tram_hash\taudio_hash\tseconds\tframes_per_s\tstatus" << std::endl;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        const auto & job = jobs[i];
+        out << i << '\t' << job.Rom << '\t' << job.Movie << '\t' << job.FramesRun << '\t'
+            << std::hex << std::setfill('0')
+            << std::setw(16) << job.FrameHash << '\t'
+            << std::setw(16) << job.RamHash << '\t'
+            << std::setw(16) << job.AudioHash << '\t'
+            << std::dec << std::setfill(' ')
+            << std::fixed << std::setprecision(3) << job.Seconds << '\t'
+            << std::setprecision(1) << (job.Seconds > 0.0 ? job.FramesRun / job.Seconds : 0.0) << '\t'
+            << (job.Done ? "ok" : job.Error) << std::endl;
+    }
+}
+
+int main(int argc, char ** argv) {
+    std::vector<std::string> positionals;
+    size_t threads = 0;
+    size_t sampleRate = 48000;
+    std::string outFilename;
+    for (int i = 1; i < argc; ++i) {
+        std::string param(argv[i]);
+        if (param[0] == '-') {
+            if (param == "-help") {
+                usage();
+                return 0;
+            } else if (param == "-threads" && i + 1 < argc) {
+                threads = std::stoul(argv[++i]);
+            } else if (param == "-rate" && i + 1 < argc) {
+                sampleRate = std::stoul(argv[++i]);
+            } else if (param == "-out" && i + 1 < argc) {
+                outFilename = argv[++i];
+            } else {
+                error("Unrecognized parameter: " + param);
+                return 1;
+            }
+        } else {
+            positionals.push_back(param);
+        }
+    }
+
+    if (positionals.size() != 1) {
+        error("Please specify a manifest file");
+        return 1;
+    }
+    try {
+        auto jobs = ReadManifest(positionals[0]);
+
+        ThreadPool pool(threads);
+        std::vector<ThreadPool::Job> work;
+        for (auto & job : jobs) {
+            work.push_back([&job, sampleRate]() { Run(job, sampleRate); });
+        }
+        const auto start = std::chrono::steady_clock::now();
+        pool.Run(work);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::ofstream outFile;
+        if (!outFilename.empty()) outFile.open(outFilename);
+        Report(outFilename.empty() ? std::cout : outFile, jobs);
+
+        size_t failed = 0;
+        for (const auto & job : jobs) failed += job.Done ? 0 : 1;
+        std::cerr << jobs.size() << " jobs, " << failed << " failed, "
+            << pool.Threads << " threads, " << elapsed.count() << " s" << std::endl;
+        return failed == 0 ? 0 : 1;
+    }
+    catch (const std::exception & e) {
+        std::cout << "Exception: " << e.what() << std::endl;
+        return 1;
+    }
+}
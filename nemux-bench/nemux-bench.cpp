@@ -0,0 +1,131 @@
+/*
+ * nemux-bench.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: scorder
+ */
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <algorithm>
+#include <array>
+
+#include "NesFile.h"
+#include "Machine.h"
+
+void usage() {
+    std::cout << "NeMux emulator benchmark" << std::endl;
+    std::cout << "Usage: nemux-bench [options] nesfile" << std::endl;
+    std::cout << "Parameters:" << std::endl;
+    std::cout << "    nesfile    Path the the NES ROM file" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "    -frames N        Frames emulated per run (default 600)" << std::endl;
+    std::cout << "    -runs N          Runs of each console, the best one is kept (default 5)" << std::endl;
+    std::cout << "    -help            Print this help message" << std::endl;
+}
+
+void error(const std::string & message) {
+    std::cout << message << std::endl;
+    std::cout << std::endl;
+    usage();
+}
+
+// Emulates frames from power up and measures the emulated frames per second
+struct Benchmark {
+    size_t frames;
+    double fps;
+    IndexedFrame frame;
+
+    explicit Benchmark(const size_t frames) : frames(frames), fps(0.0) {}
+
+    template <class Console_t>
+    void operator()(Console_t & nes) {
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < frames; ++i) {
+            nes.RunUntilFrame();
+            nes.Audio.Clear();
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        fps = frames / elapsed.count();
+        frame = nes.ppu.Screen;
+    }
+};
+
+std::unique_ptr<NesMapper> CreateMapper(const NesFile & rom) {
+    switch (rom.Header.MapperNumber) {
+    case 0: return std::unique_ptr<NesMapper>(new Mapper_000(rom));
+    case 1: return std::unique_ptr<NesMapper>(new Mapper_001(rom));
+    case 2: return std::unique_ptr<NesMapper>(new Mapper_002(rom));
+    case 3: return std::unique_ptr<NesMapper>(new Mapper_003(rom));
+    }
+    throw unsupported_format("Unsupported mapper");
+}
+
+int main(int argc, char ** argv) {
+    std::vector<std::string> positionals;
+    size_t frames = 600;
+    size_t runs = 5;
+    for (int i = 1; i < argc; ++i) {
+        std::string param(argv[i]);
+        if (param[0] == '-') {
+            if (param == "-help") {
+                usage();
+                return 0;
+            } else if (param == "-frames" && i + 1 < argc) {
+                frames = std::stoul(argv[++i]);
+            } else if (param == "-runs" && i + 1 < argc) {
+                runs = std::stoul(argv[++i]);
+            } else {
+                error("Unrecognized parameter: " + param);
+                return 1;
+            }
+        } else {
+            positionals.push_back(param);
+        }
+    }
+
+    if (positionals.size() != 1) {
+        error("Please specify a NES ROM file");
+        return 1;
+    }
+    try {
+        std::ifstream file(positionals[0], std::ios::binary);
+        NesFile rom(file);
+
+        // Runs alternate so both consoles see the same machine load
+        double dynamicFps = 0.0;
+        double staticFps = 0.0;
+        for (size_t run = 0; run < runs; ++run) {
+            Benchmark dynamicRun(frames);
+            auto mapper = CreateMapper(rom);
+            Machine machine(mapper);
+            dynamicRun(machine);
+            dynamicFps = std::max(dynamicFps, dynamicRun.fps);
+
+            Benchmark staticRun(frames);
+            WithConsole(rom, staticRun);
+            staticFps = std::max(staticFps, staticRun.fps);
+
+            if (dynamicRun.frame != staticRun.frame) {
+                throw std::runtime_error("Consoles rendered different frames");
+            }
+        }
+
+        std::cout << "Mapper " << rom.Header.MapperNumber << ", "
+            << frames << " frames, best of " << runs << " runs" << std::endl;
+        std::cout << "    Machine               " << dynamicFps << " frames/s" << std::endl;
+        std::cout << "    Console<Mapper_t>     " << staticFps << " frames/s" << std::endl;
+        std::cout << "    Speedup               " << (staticFps / dynamicFps) << std::endl;
+    }
+    catch (const std::exception & e) {
+        std::cout << "Exception: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
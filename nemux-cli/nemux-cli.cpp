@@ -7,12 +7,11 @@
 #include <sstream>
 #include <iomanip>
 #include <stdexcept>
+#include <memory>
 
 #include "NesFile.h"
 #include "Mapper_0.h"
-#include "Cpu.h"
-#include "Ppu.h"
-#include "Controllers.h"
+#include "Machine.h"
 
 using std::hex;
 using std::dec;
@@ -151,17 +150,9 @@ int main(int argc, char ** argv) {
                 start_addr.second = std::stoi(values[Options::Test_StartAt], nullptr, 0);
             }
 
-            Controllers ctrl;
-            Mapper_000 mapper(rom);
-
-            PpuMemoryMap<Palette> ppumap(nullptr, &mapper);
-            Ppu ppu(&ppumap);
-
-            Apu<Cpu> apu;
-
-            CpuMemoryMap<Cpu, Ppu, Controllers, Apu<Cpu>> cpumap(nullptr, &apu, &ppu, &mapper, &ctrl);
-            Cpu cpu("6502", &cpumap);
-            cpumap.CPU = &cpu;
+            std::unique_ptr<Mapper_000> mapper(new Mapper_000(rom));
+            Console<Mapper_000> nes(mapper);
+            Cpu & cpu = nes.cpu;
 
             if (start_addr.first) {
                 cpu.PC = start_addr.second;
@@ -182,7 +173,7 @@ int main(int argc, char ** argv) {
                     if (line.empty()) step = 1;
                     else if (line == "r") step = -1;
                     else if (line == "nt") {
-                        const Byte * nt = &ppumap.Vram[0];
+                        const Byte * nt = &nes.ppumap.Vram[0];
                         std::cout << "Nametable 0 @0x2000" << std::endl;
                         for (auto y = 0; y < 30; ++y) {
                             for (auto x = 0; x < 32; x++) {
@@ -193,7 +184,7 @@ int main(int argc, char ** argv) {
                         }
                     }
                     else if (line == "at") {
-                        const Byte * at = &ppumap.Vram[0x3C0];
+                        const Byte * at = &nes.ppumap.Vram[0x3C0];
                         std::cout << "Attribute Table 0 @0x23C0" << std::endl;
                         for (auto y = 0; y < 8; ++y) {
                             for (auto x = 0; x < 8; x++) {
@@ -220,11 +211,8 @@ int main(int argc, char ** argv) {
                     --step;
                     ++counter;
 
-                    cpu.Tick(); ppu.Tick(); ppu.Tick(); ppu.Tick();
-                    while (cpu.CurrentTick < cpu.Ticks) {
-                        cpu.Tick(); ppu.Tick(); ppu.Tick(); ppu.Tick();
-                    }
-                    //}
+                    nes.RunInstruction();
+                    nes.Audio.Clear();
 
                     std::cout << dec << counter << " " << cpu.ToMiniString() << " ";
                     if (logfile.first) {
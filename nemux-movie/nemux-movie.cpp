@@ -0,0 +1,179 @@
+/*
+ * nemux-movie.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: scorder
+ */
+
+#include <iostream>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <iomanip>
+#include <stdexcept>
+
+#include "NesFile.h"
+#include "Controllers.h"
+#include "Movie.h"
+
+void usage() {
+    std::cout << "NeMux movie converter" << std::endl;
+    std::cout << "Usage: nemux-movie [options] input output" << std::endl;
+    std::cout << "       nemux-movie -info movie" << std::endl;
+    std::cout << "Parameters:" << std::endl;
+    std::cout << "    input      Replay recorded by nemux-vis, legacy .test or binary movie" << std::endl;
+    std::cout << "    output     Binary movie written" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "    -dumps           Keep the packed pictures of the checks, for debugging" << std::endl;
+    std::cout << "    -info            Print the header and records of a movie" << std::endl;
+    std::cout << "    -help            Print this help message" << std::endl;
+}
+
+void error(const std::string & message) {
+    std::cout << message << std::endl;
+    std::cout << std::endl;
+    usage();
+}
+
+std::string Directory(const std::string & path) {
+    const auto slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+// Stands in for the console, the movie records only need the controllers
+// and the reset line
+struct MovieFrame {
+    Controllers ctrl;
+    bool ResetPressed = false;
+    void Reset() { ResetPressed = true; }
+};
+
+struct MovieStats {
+    size_t Frames = 0;
+    size_t Checks = 0;
+    size_t Resets = 0;
+};
+
+void Convert(const std::string & inPath, const std::string & outPath, const bool dumps) {
+    std::ifstream in(inPath, std::ios::binary);
+    if (!in) throw std::runtime_error("Cannot open " + inPath);
+    movie::Player player(in);
+
+    movie::Header header = player.MovieHeader;
+    std::replace(header.RomPath.begin(), header.RomPath.end(), '\\', '/');
+    if (player.IsLegacy) {
+        const auto romPath = Directory(inPath) + header.RomPath;
+        std::ifstream file(romPath, std::ios::binary);
+        if (!file) throw std::runtime_error("Cannot open " + romPath);
+        std::stringstream content;
+        content << file.rdbuf();
+        NesFile rom(content);
+        header.Mapper = rom.Header.MapperNumber;
+        header.RomSha1 = Sha1::Of(content.str());
+    }
+    // Hashes of older versions are only brought up to date from frame dumps
+    if (player.IsLegacy || (header.Flags & movie::FrameDumps)) header.Version = movie::VERSION;
+    header.Flags = dumps ? movie::FrameDumps : 0;
+
+    std::ofstream out(outPath, std::ios::binary);
+    if (!out) throw std::runtime_error("Cannot open " + outPath);
+    movie::Writer writer(out, header);
+    MovieFrame frame;
+    MovieStats stats;
+    for (;;) {
+        movie::Checkpoint check;
+        bool checked = false;
+        frame.ResetPressed = false;
+        const bool playing = player.PlayFrame(frame, [&](const movie::Checkpoint & checkpoint) {
+            if (dumps && checkpoint.Pixels.empty()) throw std::runtime_error("No frame dumps in " + inPath);
+            if (checked) throw std::runtime_error("Two checks in one frame in " + inPath);
+            check = checkpoint.Version == header.Version ? checkpoint : movie::CheckpointOf(checkpoint.Pixels);
+            checked = true;
+        });
+        if (!playing) break;
+        writer.EndFrame(replay::GetP1State(frame.ctrl), checked ? &check : nullptr, frame.ResetPressed);
+        ++stats.Frames;
+        stats.Checks += checked ? 1 : 0;
+        stats.Resets += frame.ResetPressed ? 1 : 0;
+    }
+    writer.Close();
+    std::cout << inPath << " -> " << outPath << ": " << stats.Frames << " frames, "
+        << stats.Checks << " checks, " << stats.Resets << " resets, "
+        << out.tellp() << " bytes" << std::endl;
+}
+
+void Info(const std::string & path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("Cannot open " + path);
+    movie::Player player(in);
+    const auto & header = player.MovieHeader;
+    std::cout << "Movie    " << path << std::endl;
+    if (player.IsLegacy) {
+        std::cout << "Format   legacy replay" << std::endl;
+    } else {
+        std::cout << "Format   version " << header.Version
+            << ((header.Flags & movie::FrameDumps) ? ", frame dumps" : "") << std::endl;
+        std::cout << "Mapper   " << header.Mapper << std::endl;
+        std::cout << "SHA-1    " << std::hex << std::setfill('0');
+        for (const auto b : header.RomSha1) std::cout << std::setw(2) << int(b);
+        std::cout << std::dec << std::setfill(' ') << std::endl;
+    }
+    std::cout << "ROM      " << header.RomPath << std::endl;
+
+    MovieFrame frame;
+    MovieStats stats;
+    for (;;) {
+        frame.ResetPressed = false;
+        const bool playing = player.PlayFrame(frame, [&](const movie::Checkpoint & checkpoint) {
+            std::cout << "Check    frame " << stats.Frames + 1 << " hash " << std::hex << std::setfill('0')
+                << std::setw(16) << checkpoint.Hash << std::dec << std::setfill(' ') << std::endl;
+        });
+        if (!playing) break;
+        ++stats.Frames;
+        stats.Resets += frame.ResetPressed ? 1 : 0;
+    }
+    std::cout << "Frames   " << stats.Frames << " (" << stats.Resets << " resets)" << std::endl;
+}
+
+int main(int argc, char ** argv) {
+    std::vector<std::string> positionals;
+    bool dumps = false;
+    bool info = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string param(argv[i]);
+        if (param[0] == '-') {
+            if (param == "-help") {
+                usage();
+                return 0;
+            } else if (param == "-dumps") {
+                dumps = true;
+            } else if (param == "-info") {
+                info = true;
+            } else {
+                error("Unrecognized parameter: " + param);
+                return 1;
+            }
+        } else {
+            positionals.push_back(param);
+        }
+    }
+
+    try {
+        if (info && positionals.size() == 1) {
+            Info(positionals[0]);
+        } else if (!info && positionals.size() == 2) {
+            Convert(positionals[0], positionals[1], dumps);
+        } else {
+            error("Please specify an input and an output movie");
+            return 1;
+        }
+    }
+    catch (const std::exception & e) {
+        std::cout << "Exception: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,222 @@
+/*
+ * nemux-romtest.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: scorder
+ */
+
+#include <iostream>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <iomanip>
+#include <stdexcept>
+
+#include "NesFile.h"
+#include "Machine.h"
+#include "Movie.h"
+#include "ThreadPool.h"
+
+void usage() {
+    std::cout << "NeMux headless test ROM runner" << std::endl;
+    std::cout << "Usage: nemux-romtest [options] testfile..." << std::endl;
+    std::cout << "Parameters:" << std::endl;
+    std::cout << "    testfile   Movie recorded with nemux-vis -record or legacy .test replay," << std::endl;
+    std::cout << "               the ROM path it holds starts at its directory" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "    -list FILE       Also run the replays listed in FILE, one path per line" << std::endl;
+    std::cout << "    -threads N       Worker threads (default one per hardware thread)" << std::endl;
+    std::cout << "    -help            Print this help message" << std::endl;
+}
+
+void error(const std::string & message) {
+    std::cout << message << std::endl;
+    std::cout << std::endl;
+    usage();
+}
+
+struct RomTest {
+    std::string Path;
+
+    // Results
+    enum class Status { NotRun, Passed, Failed, NoCheck, Error } Result = Status::NotRun;
+    std::string Error;
+    size_t Frames = 0;
+    size_t Checks = 0;
+    size_t ChecksPassed = 0;
+    // First mismatching check, the pixel is only known with frame dumps
+    size_t FailedFrame = 0;
+    bool HasFailedPixel = false;
+    size_t FailedPixel = 0;
+    Word Expected = 0;
+    Word Actual = 0;
+    uint64_t ExpectedHash = 0;
+    uint64_t ActualHash = 0;
+    double Seconds = 0.0;
+};
+
+// Plays the movie and compares every check against the console picture
+struct RomTestSession {
+    RomTest & test;
+    movie::Player & player;
+
+    RomTestSession(RomTest & test, movie::Player & player) : test(test), player(player) {}
+
+    template <class Console_t>
+    void operator()(Console_t & nes) {
+        auto check = [this, &nes](const movie::Checkpoint & checkpoint) {
+            ++test.Checks;
+            if (checkpoint.Matches(nes.ppu.Screen)) {
+                ++test.ChecksPassed;
+            } else if (test.Checks - test.ChecksPassed == 1) {
+                const auto picture = movie::PictureOf(nes.ppu.Screen);
+                test.FailedFrame = test.Frames;
+                test.ExpectedHash = checkpoint.Hash;
+                test.ActualHash = movie::HashOf(picture, checkpoint.Version);
+                for (size_t i = 0; i < checkpoint.Pixels.size() && !test.HasFailedPixel; ++i) {
+                    if (checkpoint.Pixels[i] == picture[i]) continue;
+                    test.HasFailedPixel = true;
+                    test.FailedPixel = i;
+                    test.Expected = checkpoint.Pixels[i];
+                    test.Actual = picture[i];
+                }
+            }
+        };
+        do {
+            nes.RunUntilFrame();
+            nes.Audio.Clear();
+            ++test.Frames;
+        } while (player.PlayFrame(nes, check));
+    }
+};
+
+std::string Directory(const std::string & path) {
+    const auto slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+void Run(RomTest & test) {
+    const auto start = std::chrono::steady_clock::now();
+    try {
+        std::ifstream movieFile(test.Path, std::ios::binary);
+        if (!movieFile) throw std::runtime_error("Cannot open " + test.Path);
+        movie::Player player(movieFile);
+        auto romPath = player.MovieHeader.RomPath;
+        std::replace(romPath.begin(), romPath.end(), '\\', '/');
+        romPath = Directory(test.Path) + romPath;
+
+        std::ifstream file(romPath, std::ios::binary);
+        if (!file) throw std::runtime_error("Cannot open " + romPath);
+        std::stringstream content;
+        content << file.rdbuf();
+        if (!player.IsLegacy && Sha1::Of(content.str()) != player.MovieHeader.RomSha1) {
+            throw std::runtime_error("Recorded with another ROM than " + romPath);
+        }
+        NesFile rom(content);
+        RomTestSession session(test, player);
+        WithConsole(rom, session);
+
+        if (test.Checks == 0) test.Result = RomTest::Status::NoCheck;
+        else if (test.ChecksPassed == test.Checks) test.Result = RomTest::Status::Passed;
+        else test.Result = RomTest::Status::Failed;
+    }
+    catch (const std::exception & e) {
+        test.Result = RomTest::Status::Error;
+        test.Error = e.what();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    test.Seconds = elapsed.count();
+}
+
+void Report(const RomTest & test) {
+    std::cout << std::fixed << std::setprecision(2) << std::setw(6) << test.Seconds << "s  ";
+    switch (test.Result) {
+    case RomTest::Status::Passed:  std::cout << "PASS     "; break;
+    case RomTest::Status::Failed:  std::cout << "FAIL     "; break;
+    case RomTest::Status::NoCheck: std::cout << "NO CHECK "; break;
+    case RomTest::Status::Error:   std::cout << "ERROR    "; break;
+    case RomTest::Status::NotRun:  std::cout << "NOT RUN  "; break;
+    }
+    std::cout << test.Path << "  " << test.Frames << " frames, "
+        << test.ChecksPassed << "/" << test.Checks << " checks";
+    if (test.Result == RomTest::Status::Failed) {
+        std::cout << ", frame " << test.FailedFrame << std::hex << std::setfill('0');
+        if (test.HasFailedPixel) {
+            std::cout << " pixel (" << std::dec << test.FailedPixel % FRAME_WIDTH << ", " << test.FailedPixel / FRAME_WIDTH << ")"
+                << std::hex << " expected $" << std::setw(3) << test.Expected << " got $" << std::setw(3) << test.Actual;
+        } else {
+            std::cout << " hash expected " << std::setw(16) << test.ExpectedHash << " got " << std::setw(16) << test.ActualHash;
+        }
+        std::cout << std::dec << std::setfill(' ');
+    }
+    if (test.Result == RomTest::Status::Error) std::cout << ", " << test.Error;
+    std::cout << std::endl;
+}
+
+int main(int argc, char ** argv) {
+    std::vector<std::string> positionals;
+    size_t threads = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string param(argv[i]);
+        if (param[0] == '-') {
+            if (param == "-help") {
+                usage();
+                return 0;
+            } else if (param == "-threads" && i + 1 < argc) {
+                threads = std::stoul(argv[++i]);
+            } else if (param == "-list" && i + 1 < argc) {
+                std::ifstream list(argv[++i]);
+                if (!list) {
+                    error("Cannot open " + std::string(argv[i]));
+                    return 1;
+                }
+                std::string line;
+                while (std::getline(list, line)) {
+                    if (!line.empty() && line.back() == '\r') line.pop_back();
+                    if (!line.empty()) positionals.push_back(line);
+                }
+            } else {
+                error("Unrecognized parameter: " + param);
+                return 1;
+            }
+        } else {
+            positionals.push_back(param);
+        }
+    }
+
+    if (positionals.empty()) {
+        error("Please specify test replay files");
+        return 1;
+    }
+
+    // One console per replay, each job only touches its own RomTest
+    std::vector<RomTest> tests(positionals.size());
+    std::vector<ThreadPool::Job> jobs;
+    for (size_t i = 0; i < tests.size(); ++i) {
+        tests[i].Path = positionals[i];
+        jobs.push_back([&tests, i]() { Run(tests[i]); });
+    }
+    ThreadPool pool(threads);
+    const auto start = std::chrono::steady_clock::now();
+    pool.Run(jobs);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    size_t passed = 0;
+    size_t failed = 0;
+    double romSeconds = 0.0;
+    for (const auto & test : tests) {
+        Report(test);
+        if (test.Result == RomTest::Status::Passed) ++passed;
+        if (test.Result == RomTest::Status::Failed || test.Result == RomTest::Status::Error) ++failed;
+        romSeconds += test.Seconds;
+    }
+    std::cout << std::endl << passed << " passed, " << failed << " failed, "
+        << (tests.size() - passed - failed) << " without checks, "
+        << std::setprecision(2) << elapsed.count() << "s on " << pool.Threads << " threads ("
+        << romSeconds << "s summed per-ROM time)" << std::endl;
+
+    return failed == 0 ? 0 : 1;
+}
@@ -36,9 +36,9 @@ struct ApuTest : public ::testing::Test {
     DMC<Cpu> dmc;
 
     Cpu cpu;
-    Ppu ppu;
+    Ppu<> ppu;
     Controllers ctrl;
-    CpuMemoryMap<Cpu, Ppu, Controllers, Apu<Cpu>> cpumap;
+    CpuMemoryMap<Cpu, Ppu<>, Controllers, Apu<Cpu>> cpumap;
     MonitoredNesMapper mapper;
     DMAReader<Cpu> dma;
     
@@ -1283,3 +1283,75 @@ TEST_F(ApuTest, Divider_PeriodChangeDoesNotReset) {
     EXPECT_FALSE(d.Tick());
     EXPECT_TRUE(d.Tick());
 }
+
+TEST_F(ApuTest, APU_CatchUpSameSamplesAsTick) {
+    struct Write { size_t Cycle; Word Address; Byte Value; };
+    const std::vector<Write> writes = {
+        { 10, 0x4015, 0x0F },
+        { 20, 0x4000, 0xBF }, { 21, 0x4002, 0xFD }, { 22, 0x4003, 0x08 },
+        { 30, 0x4004, 0x5A }, { 31, 0x4005, 0x9A }, { 32, 0x4006, 0x40 }, { 33, 0x4007, 0x21 },
+        { 40, 0x4008, 0x81 }, { 41, 0x400A, 0x50 }, { 42, 0x400B, 0x08 },
+        { 50, 0x400C, 0x3F }, { 51, 0x400E, 0x04 }, { 52, 0x400F, 0x08 },
+        { 60, 0x4011, 0x40 },
+        { 70, 0x4010, 0x8E }, { 71, 0x4012, 0x00 }, { 72, 0x4013, 0x01 }, { 73, 0x4015, 0x1F },
+        { 20000, 0x400C, 0x30 },
+        { 30000, 0x4017, 0x00 },
+        { 45000, 0x4002, 0x10 }, { 45001, 0x4003, 0x01 },
+        { 60000, 0x4017, 0x80 },
+        { 75000, 0x4015, 0x05 },
+    };
+    auto write = [](Apu<Cpu> & target, const Word address, const Byte value) {
+        if (address == 0x4000) target.WritePulse1Control(value);
+        if (address == 0x4002) target.WritePulse1PeriodLo(value);
+        if (address == 0x4003) target.WritePulse1PeriodHi(value);
+        if (address == 0x4004) target.WritePulse2Control(value);
+        if (address == 0x4005) target.WritePulse2Sweep(value);
+        if (address == 0x4006) target.WritePulse2PeriodLo(value);
+        if (address == 0x4007) target.WritePulse2PeriodHi(value);
+        if (address == 0x4008) target.WriteTriangleControl(value);
+        if (address == 0x400A) target.WriteTrianglePeriodLo(value);
+        if (address == 0x400B) target.WriteTrianglePeriodHi(value);
+        if (address == 0x400C) target.WriteNoiseControl(value);
+        if (address == 0x400E) target.WriteNoisePeriod(value);
+        if (address == 0x400F) target.WriteNoiseLength(value);
+        if (address == 0x4010) target.WriteDMCFrequency(value);
+        if (address == 0x4011) target.WriteDMCDAC(value);
+        if (address == 0x4012) target.WriteDMCAddress(value);
+        if (address == 0x4013) target.WriteDMCLength(value);
+        if (address == 0x4015) target.WriteCommonEnable(value);
+        if (address == 0x4017) target.WriteCommonControl(value);
+    };
+    static constexpr size_t CYCLES = 90000;
+    EXPECT_CALL(mapper, GetCpuAt(_)).WillRepeatedly(Return(0xA5));
+
+    Apu<Cpu> ticked;
+    ticked.DMC1.Output.DMA.CPU = &cpu;
+    std::vector<float> expected;
+    std::vector<bool> interrupts;
+    auto next = writes.begin();
+    for (size_t cycle = 0; cycle < CYCLES; ++cycle) {
+        for (; next != writes.end() && next->Cycle == cycle; ++next) write(ticked, next->Address, next->Value);
+        expected.push_back(ticked.Tick());
+        interrupts.push_back(ticked.Frame.Interrupt || ticked.DMC1.Output.DMA.Interrupt);
+    }
+
+    Apu<Cpu> scheduled;
+    scheduled.DMC1.Output.DMA.CPU = &cpu;
+    std::vector<float> samples;
+    scheduled.Samples = &samples;
+    next = writes.begin();
+    for (size_t cycle = 0; cycle < CYCLES; ++cycle) {
+        for (; next != writes.end() && next->Cycle == cycle; ++next) {
+            scheduled.Sync();
+            write(scheduled, next->Address, next->Value);
+        }
+        scheduled.Schedule(1);
+        ASSERT_EQ(interrupts[cycle], scheduled.Frame.Interrupt || scheduled.DMC1.Output.DMA.Interrupt) << "Cycle " << cycle;
+    }
+    scheduled.CatchUp();
+
+    ASSERT_EQ(expected.size(), samples.size());
+    for (size_t i = 0; i < samples.size(); ++i) {
+        ASSERT_EQ(expected[i], samples[i]) << "Cycle " << i;
+    }
+}
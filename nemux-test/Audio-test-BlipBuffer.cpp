@@ -0,0 +1,63 @@
+/*
+ * Audio-test-BlipBuffer.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: scorder
+ */
+
+#include "gtest/gtest.h"
+
+#include "BlipBuffer.h"
+
+#include <vector>
+
+struct BlipBufferTest : public ::testing::Test {
+    static constexpr size_t CLOCK_RATE = 1789773;
+    static constexpr size_t SAMPLE_RATE = 48000;
+
+    BlipBuffer blip;
+
+    BlipBufferTest() : blip(CLOCK_RATE, SAMPLE_RATE) {}
+
+    std::vector<int16_t> ReadAll() {
+        std::vector<int16_t> samples(blip.SamplesAvailable());
+        samples.resize(blip.ReadSamples(samples.data(), samples.size()));
+        return samples;
+    }
+};
+
+TEST_F(BlipBufferTest, SamplesAtHostRate) {
+    // One second in 60 frames
+    for (int frame = 0; frame < 60; ++frame) blip.EndFrame(CLOCK_RATE / 60);
+    EXPECT_NEAR(double(SAMPLE_RATE), double(blip.SamplesAvailable()), 1.0);
+}
+
+TEST_F(BlipBufferTest, SilenceWithoutDeltas) {
+    blip.EndFrame(29781);
+    for (const auto s : ReadAll()) EXPECT_EQ(0, s);
+}
+
+TEST_F(BlipBufferTest, StepSettlesToLevel) {
+    blip.AddDelta(1000, 0.5f);
+    blip.EndFrame(29781);
+    const auto samples = ReadAll();
+    ASSERT_LT(100u, samples.size());
+
+    // Step starts around sample 1000 / 37.3 ~= 27, delayed by half the kernel
+    const size_t step = 1000 * SAMPLE_RATE / CLOCK_RATE;
+    for (size_t i = 0; i < step; ++i) EXPECT_EQ(0, samples[i]) << "Sample " << i;
+    EXPECT_NEAR(0.5 * blip.Gain, samples[step + BlipBuffer::TAPS + 4], 0.02 * blip.Gain);
+}
+
+TEST_F(BlipBufferTest, ReadKeepsRemainingSamples) {
+    blip.AddDelta(10, 1.0f);
+    blip.EndFrame(29781);
+    const auto available = blip.SamplesAvailable();
+
+    std::vector<int16_t> first(100);
+    EXPECT_EQ(100u, blip.ReadSamples(first.data(), first.size()));
+    EXPECT_EQ(available - 100, blip.SamplesAvailable());
+
+    blip.Clear();
+    EXPECT_EQ(0u, blip.SamplesAvailable());
+}
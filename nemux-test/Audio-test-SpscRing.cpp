@@ -0,0 +1,76 @@
+/*
+ * Audio-test-SpscRing.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: scorder
+ */
+
+#include "gtest/gtest.h"
+
+#include "SpscRing.h"
+
+#include <thread>
+#include <vector>
+
+TEST(SpscRingTest, PopIsAllOrNothing) {
+    SpscRing<int, 8> ring;
+    const int in[3] = { 1, 2, 3 };
+    EXPECT_EQ(3u, ring.Push(in, 3));
+
+    int out[4] = {};
+    EXPECT_FALSE(ring.Pop(out, 4));
+    EXPECT_EQ(1u, ring.Underruns);
+    EXPECT_EQ(3u, ring.Available());
+
+    EXPECT_TRUE(ring.Pop(out, 3));
+    EXPECT_EQ(1, out[0]);
+    EXPECT_EQ(3, out[2]);
+    EXPECT_EQ(0u, ring.Available());
+}
+
+TEST(SpscRingTest, PushDropsWhenFull) {
+    SpscRing<int, 8> ring;
+    const int in[6] = { 1, 2, 3, 4, 5, 6 };
+    EXPECT_EQ(6u, ring.Push(in, 6));
+    EXPECT_EQ(2u, ring.Push(in, 6));
+    EXPECT_EQ(4u, ring.Overruns);
+
+    int out[8] = {};
+    EXPECT_TRUE(ring.Pop(out, 8));
+    EXPECT_EQ(6, out[5]);
+    EXPECT_EQ(2, out[7]);
+}
+
+TEST(SpscRingTest, WrapsAround) {
+    SpscRing<int, 4> ring;
+    int out[3] = {};
+    for (int i = 0; i < 10; ++i) {
+        const int in[3] = { i, i + 1, i + 2 };
+        EXPECT_EQ(3u, ring.Push(in, 3));
+        EXPECT_TRUE(ring.Pop(out, 3));
+        EXPECT_EQ(i + 2, out[2]);
+    }
+}
+
+TEST(SpscRingTest, ProducerAndConsumerThreads) {
+    static constexpr int COUNT = 200000;
+    SpscRing<int, 256> ring;
+
+    std::thread producer([&ring]() {
+        int next = 0;
+        while (next < COUNT) {
+            const int chunk[16] = { next, next + 1, next + 2, next + 3, next + 4, next + 5, next + 6, next + 7,
+                next + 8, next + 9, next + 10, next + 11, next + 12, next + 13, next + 14, next + 15 };
+            next += int(ring.Push(chunk, 16));
+        }
+    });
+
+    std::vector<int> received;
+    int chunk[16];
+    while (received.size() < COUNT) {
+        if (ring.Pop(chunk, 16)) received.insert(received.end(), chunk, chunk + 16);
+    }
+    producer.join();
+
+    for (int i = 0; i < COUNT; ++i) ASSERT_EQ(i, received[i]);
+}
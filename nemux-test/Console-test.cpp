@@ -0,0 +1,261 @@
+/*
+ * Console-test.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: scorder
+ */
+
+#include "gtest/gtest.h"
+
+#include "Machine.h"
+
+#include <array>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+struct ConsoleTest : public ::testing::Test {
+    std::string image;
+
+    // NROM-128 turning on NMI and rendering, the NMI handler scrolls the
+    // screen and counts frames at $0000
+    ConsoleTest() {
+        image = std::string(16, 0);
+        image.replace(0, 4, NES_TAG);
+        image[4] = 1;
+        image[5] = 1;
+        image[6] = Mask<NesFile::HeaderDesc::Mirroring>(1);
+
+        std::string prg(0x4000, char(0xEA));
+        const unsigned char code[] = {
+            0x78,               // 8000 SEI
+            0xA9, 0x80,         // 8001 LDA #$80
+            0x8D, 0x00, 0x20,   // 8003 STA $2000
+            0xA9, 0x1E,         // 8006 LDA #$1E
+            0x8D, 0x01, 0x20,   // 8008 STA $2001
+            0x4C, 0x0B, 0x80,   // 800B JMP $800B
+        };
+        const unsigned char nmi[] = {
+            0xE6, 0x00,         // 8010 INC $00
+            0xA5, 0x00,         // 8012 LDA $00
+            0x8D, 0x05, 0x20,   // 8014 STA $2005
+            0x40,               // 8017 RTI
+        };
+        prg.replace(0x0000, sizeof(code), (const char *) code, sizeof(code));
+        prg.replace(0x0010, sizeof(nmi), (const char *) nmi, sizeof(nmi));
+        const unsigned char vectors[] = { 0x10, 0x80, 0x00, 0x80, 0x0B, 0x80 };
+        prg.replace(0x3FFA, sizeof(vectors), (const char *) vectors, sizeof(vectors));
+        image += prg;
+
+        std::string chr(0x2000, 0);
+        for (size_t i = 0; i < chr.size(); ++i) chr[i] = char((i * 7) ^ (i >> 3));
+        image += chr;
+    }
+
+    NesFile Rom(const Byte mapper) const {
+        std::string data(image);
+        data[6] = char(data[6] | ((mapper & 0x0F) << 4));
+        data[7] = char(mapper & 0xF0);
+        std::istringstream iss(data);
+        return NesFile(iss);
+    }
+};
+
+struct FrameSession {
+    bool isNrom = false;
+    IndexedFrame frame;
+    std::array<Byte, 0x0800> ram;
+
+    template <class Console_t>
+    void operator()(Console_t & nes) {
+        isNrom = std::is_same<Console_t, Console<Mapper_000>>::value;
+        for (int i = 0; i < 10; ++i) nes.RunUntilFrame();
+        frame = nes.ppu.Screen;
+        ram = nes.cpumap.RAM;
+    }
+};
+
+TEST_F(ConsoleTest, FactoryPicksMapperInstantiation) {
+    FrameSession session;
+    WithConsole(Rom(0), session);
+    EXPECT_TRUE(session.isNrom);
+    EXPECT_EQ(10, session.ram[0x0000]);
+}
+
+TEST_F(ConsoleTest, FactoryRejectsUnknownMapper) {
+    FrameSession session;
+    EXPECT_THROW(WithConsole(Rom(4), session), unsupported_format);
+}
+
+TEST_F(ConsoleTest, SameFramesAsMachine) {
+    FrameSession concrete;
+    WithConsole(Rom(0), concrete);
+
+    FrameSession dynamic;
+    std::unique_ptr<NesMapper> mapper(new Mapper_000(Rom(0)));
+    Machine machine(mapper);
+    dynamic(machine);
+
+    EXPECT_FALSE(dynamic.isNrom);
+    EXPECT_TRUE(concrete.frame == dynamic.frame);
+    EXPECT_TRUE(concrete.ram == dynamic.ram);
+}
+
+TEST_F(ConsoleTest, SameFramesAloneOrInterleaved) {
+    // Consoles start out of phase and take turns every few cycles so every
+    // PPU and CPU state is crossed by the others
+    static constexpr size_t CONSOLES = 3;
+    static constexpr size_t SLICE = 5;
+    static constexpr size_t SLICES_PER_CHECK = Machine::CYCLES_PER_FRAME / SLICE;
+    static constexpr size_t CHECKS = 6;
+    const NesFile rom = Rom(0);
+    auto Start = [&rom](const size_t i) {
+        std::unique_ptr<NesMapper> mapper(new Mapper_000(rom));
+        std::unique_ptr<Machine> machine(new Machine(mapper));
+        machine->RunCycles(9001 * i);
+        return machine;
+    };
+
+    std::vector<std::vector<IndexedFrame>> alone(CONSOLES);
+    for (size_t i = 0; i < CONSOLES; ++i) {
+        auto machine = Start(i);
+        for (size_t c = 0; c < CHECKS; ++c) {
+            for (size_t s = 0; s < SLICES_PER_CHECK; ++s) machine->RunCycles(SLICE);
+            alone[i].push_back(machine->ppu.Screen);
+        }
+    }
+
+    std::vector<std::unique_ptr<Machine>> machines;
+    for (size_t i = 0; i < CONSOLES; ++i) machines.push_back(Start(i));
+    for (size_t c = 0; c < CHECKS; ++c) {
+        for (size_t s = 0; s < SLICES_PER_CHECK; ++s) {
+            for (auto & machine : machines) machine->RunCycles(SLICE);
+        }
+        for (size_t i = 0; i < CONSOLES; ++i) {
+            EXPECT_TRUE(alone[i][c] == machines[i]->ppu.Screen) << "Console " << i << " check " << c;
+        }
+    }
+}
+
+TEST_F(ConsoleTest, SaveStateResumesAnywhere) {
+    // Cut points land inside instructions, NMI sequences and VBlank
+    const NesFile rom = Rom(0);
+    for (const size_t cut : { size_t(1), size_t(7), size_t(27395), size_t(89342), size_t(123457) }) {
+        std::unique_ptr<NesMapper> mapper(new Mapper_000(rom));
+        Machine machine(mapper);
+        machine.RunCycles(cut);
+        const auto state = machine.SaveState();
+        for (int i = 0; i < 3; ++i) machine.RunUntilFrame();
+        const auto frame = machine.ppu.Screen;
+        const auto ram = machine.cpumap.RAM;
+        const auto after = machine.SaveState();
+
+        // Back in the same console, then in a fresh one
+        machine.LoadState(state);
+        EXPECT_TRUE(state == machine.SaveState()) << "Cut " << cut;
+        for (int i = 0; i < 3; ++i) machine.RunUntilFrame();
+        EXPECT_TRUE(frame == machine.ppu.Screen) << "Cut " << cut;
+        EXPECT_TRUE(after == machine.SaveState()) << "Cut " << cut;
+
+        std::unique_ptr<NesMapper> other(new Mapper_000(rom));
+        Machine fresh(other);
+        fresh.LoadState(state);
+        for (int i = 0; i < 3; ++i) fresh.RunUntilFrame();
+        EXPECT_TRUE(frame == fresh.ppu.Screen) << "Cut " << cut;
+        EXPECT_TRUE(ram == fresh.cpumap.RAM) << "Cut " << cut;
+        EXPECT_TRUE(after == fresh.SaveState()) << "Cut " << cut;
+    }
+}
+
+struct StateSession {
+    std::vector<Byte> state;
+    IndexedFrame frame;
+
+    template <class Console_t>
+    void operator()(Console_t & nes) {
+        for (int i = 0; i < 4; ++i) nes.RunUntilFrame();
+        nes.RunCycles(1234);
+        state = nes.SaveState();
+        for (int i = 0; i < 2; ++i) nes.RunUntilFrame();
+        frame = nes.ppu.Screen;
+    }
+};
+
+TEST_F(ConsoleTest, SaveStateAcrossInstantiations) {
+    // States hold no pointer so the concrete and the virtual consoles of a
+    // cartridge load each other's states
+    for (const Byte number : { Byte(0), Byte(1), Byte(3) }) {
+        const NesFile rom = Rom(number);
+        StateSession session;
+        WithConsole(rom, session);
+
+        std::unique_ptr<NesMapper> mapper;
+        if (number == 0) mapper.reset(new Mapper_000(rom));
+        if (number == 1) mapper.reset(new Mapper_001(rom));
+        if (number == 3) mapper.reset(new Mapper_003(rom));
+        Machine machine(mapper);
+        machine.LoadState(session.state);
+        for (int i = 0; i < 2; ++i) machine.RunUntilFrame();
+        EXPECT_TRUE(session.frame == machine.ppu.Screen) << "Mapper " << int(number);
+    }
+}
+
+TEST_F(ConsoleTest, LoadStateRejectsOtherData) {
+    std::unique_ptr<NesMapper> mapper(new Mapper_000(Rom(0)));
+    Machine machine(mapper);
+    auto state = machine.SaveState();
+
+    auto truncated = state;
+    truncated.resize(state.size() / 2);
+    EXPECT_THROW(machine.LoadState(truncated), invalid_format);
+
+    auto longer = state;
+    longer.push_back(0);
+    EXPECT_THROW(machine.LoadState(longer), invalid_format);
+
+    auto magic = state;
+    magic[0] ^= 0xFF;
+    EXPECT_THROW(machine.LoadState(magic), invalid_format);
+
+    auto version = state;
+    version[4] ^= 0xFF;
+    EXPECT_THROW(machine.LoadState(version), unsupported_format);
+
+    // Mapper 1 saves its registers and PRG RAM on top
+    std::unique_ptr<NesMapper> mmc1(new Mapper_001(Rom(1)));
+    Machine other(mmc1);
+    EXPECT_THROW(other.LoadState(state), invalid_format);
+}
+
+TEST_F(ConsoleTest, RunAheadLeavesNoTrace) {
+    // Frames run muted then undone by a state load, as run-ahead does, must
+    // not change the frames and sound of the console
+    const NesFile rom = Rom(0);
+    std::unique_ptr<NesMapper> mapper(new Mapper_000(rom));
+    Machine plain(mapper);
+    std::unique_ptr<NesMapper> other(new Mapper_000(rom));
+    Machine ahead(other);
+    std::vector<Byte> state;
+    for (int frame = 0; frame < 12; ++frame) {
+        plain.RunUntilFrame();
+        ahead.RunUntilFrame();
+        ahead.SaveState(state);
+        ahead.MuteAudio(true);
+        for (int i = 0; i < 3; ++i) ahead.RunUntilFrame();
+        ahead.MuteAudio(false);
+        ahead.LoadState(state);
+    }
+    plain.RunUntilFrame();
+    ahead.RunUntilFrame();
+    EXPECT_TRUE(plain.ppu.Screen == ahead.ppu.Screen);
+    EXPECT_TRUE(plain.SaveState() == ahead.SaveState());
+
+    ASSERT_EQ(plain.Audio.SamplesAvailable(), ahead.Audio.SamplesAvailable());
+    std::vector<int16_t> expected(plain.Audio.SamplesAvailable());
+    std::vector<int16_t> actual(expected.size());
+    plain.Audio.ReadSamples(expected.data(), expected.size());
+    ahead.Audio.ReadSamples(actual.data(), actual.size());
+    EXPECT_EQ(expected, actual);
+}
@@ -0,0 +1,215 @@
+/*
+ * Cpu-test-fastpath.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: scorder
+ */
+
+#include "gtest/gtest.h"
+
+#include "Cpu.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+class CpuTestFastPath : public ::testing::Test {
+public:
+    static const Word BASE_PC = 0x8000;
+
+    struct State {
+        size_t Ticks;
+        Word PC;
+        Byte A, X, Y, SP, P;
+        bool operator==(const State & other) const {
+            return Ticks == other.Ticks && PC == other.PC
+                && A == other.A && X == other.X && Y == other.Y
+                && SP == other.SP && P == other.P;
+        }
+    };
+
+    CpuTestFastPath() : memory(), cpu("6502", &memory) {}
+
+    void Load(const vector<Byte> & program) {
+        for (size_t i = 0; i < program.size(); ++i) {
+            memory.SetByteAt(BASE_PC + i, program[i]);
+        }
+        cpu.PC = BASE_PC;
+        cpu.SP = 0xFD;
+    }
+
+    // Registers at every instruction boundary
+    static vector<State> Trace(Cpu & cpu, const size_t cycles) {
+        vector<State> trace;
+        for (size_t i = 0; i < cycles; ++i) {
+            cpu.Tick();
+            if (cpu.CurrentTick == cpu.Ticks) {
+                trace.push_back({ cpu.Ticks, cpu.PC, cpu.A, cpu.X, cpu.Y, cpu.SP, cpu.GetStatus() });
+            }
+        }
+        return trace;
+    }
+
+    size_t InstructionCycles() {
+        const auto start = cpu.Ticks;
+        do {
+            cpu.Tick();
+        } while (cpu.CurrentTick != cpu.Ticks);
+        return cpu.Ticks - start;
+    }
+
+    MemoryBlock<0x10000> memory;
+    Cpu cpu;
+};
+
+// Cartridge space is read-only unless banks are switched
+struct BankedMemory : public MemoryMap {
+    std::array<Byte, 0x10000> Data;
+    size_t Generation = 0;
+
+    Byte GetByteAt(const Word address) const override { return Data[address]; }
+    void SetByteAt(const Word address, const Byte value) override { Data[address] = value; }
+    const size_t * PrgGeneration() const override { return &Generation; }
+};
+
+// Banks at $C000-$FFFF switched through a page table, $8000-$BFFF fixed
+struct PagedBankedMemory : public MemoryMap {
+    std::array<Byte, 0x10000> Data;
+    std::array<std::array<Byte, 0x4000>, 2> Banks;
+    PageTable Pages;
+    size_t Generation = 0;
+
+    PagedBankedMemory() { Pages.MapRead(0x8000, 0x4000, Data.data() + 0x8000); }
+
+    void Switch(const size_t bank) {
+        Pages.MapRead(0xC000, 0x4000, Banks[bank].data());
+        ++Generation;
+    }
+
+    Byte GetByteAt(const Word address) const override {
+        const auto page = Pages.Read[PageTable::Page(address)];
+        return (page != nullptr) ? page[address & PageTable::PAGE_MASK] : Data[address];
+    }
+    void SetByteAt(const Word address, const Byte value) override { Data[address] = value; }
+    const size_t * PrgGeneration() const override { return &Generation; }
+    const PageTable * DirectPages() const override { return &Pages; }
+};
+
+const Word CpuTestFastPath::BASE_PC;
+
+TEST_F(CpuTestFastPath, SameTraceAsMicroOps) {
+    const vector<Byte> program = {
+        0xA2, 0x00,       //       LDX #$00
+        0xA0, 0x10,       //       LDY #$10
+        0xBD, 0xF8, 0x02, // loop: LDA $02F8,X  page crossing
+        0x69, 0x07,       //       ADC #$07
+        0x9D, 0x00, 0x04, //       STA $0400,X
+        0x8D, 0x06, 0x20, //       STA $2006    I/O
+        0xFE, 0x00, 0x05, //       INC $0500,X
+        0x91, 0x10,       //       STA ($10),Y
+        0x20, 0x20, 0x80, //       JSR sub
+        0xE8,             //       INX
+        0xD0, 0xEA,       //       BNE loop
+        0x6C, 0x30, 0x00, //       JMP ($0030)
+        0x00, 0x00, 0x00,
+        0x48,             // sub:  PHA
+        0x68,             //       PLA
+        0x60,             //       RTS
+    };
+    vector<State> traces[2];
+    vector<Byte> memories[2];
+    for (int fast = 0; fast < 2; ++fast) {
+        for (int i = 0; i < 0x10000; ++i) memory.SetByteAt(i, Byte(i * 7));
+        memory.SetByteAt(0x0010, 0xF8);
+        memory.SetByteAt(0x0011, 0x1F);
+        memory.SetByteAt(0x0030, 0x00);
+        memory.SetByteAt(0x0031, 0x80);
+        Load(program);
+
+        Cpu runner("6502", &memory);
+        runner.PC = BASE_PC;
+        runner.SP = 0xFD;
+        runner.FastPath = (fast == 1);
+        traces[fast] = Trace(runner, 20000);
+        for (int i = 0; i < 0x10000; ++i) memories[fast].push_back(memory.GetByteAt(i));
+    }
+    ASSERT_LT(1000u, traces[0].size());
+    ASSERT_EQ(traces[0].size(), traces[1].size());
+    for (size_t i = 0; i < traces[0].size(); ++i) {
+        EXPECT_TRUE(traces[0][i] == traces[1][i]) << "Instruction " << i;
+    }
+    EXPECT_EQ(memories[0], memories[1]);
+}
+
+TEST_F(CpuTestFastPath, CyclesPerInstruction) {
+    Load({
+        0xBD, 0xFF, 0x02, // LDA $02FF,X  page crossing
+        0x9D, 0xFF, 0x02, // STA $02FF,X
+        0xFE, 0x00, 0x03, // INC $0300,X
+        0xB1, 0x10,       // LDA ($10),Y  page crossing
+        0xAD, 0x02, 0x20, // LDA $2002    I/O
+        0xEA,             // NOP
+    });
+    memory.SetByteAt(0x0010, 0xFF);
+    memory.SetByteAt(0x0011, 0x02);
+    cpu.X = 1;
+    cpu.Y = 1;
+    cpu.FastPath = true;
+
+    EXPECT_EQ(5, InstructionCycles());
+    EXPECT_EQ(5, InstructionCycles());
+    EXPECT_EQ(7, InstructionCycles());
+    EXPECT_EQ(6, InstructionCycles());
+    EXPECT_EQ(4, InstructionCycles());
+    EXPECT_EQ(2, InstructionCycles());
+}
+
+TEST_F(CpuTestFastPath, BankSwitchDropsDecodedCode) {
+    BankedMemory banked;
+    banked.Data.fill(0xEA);
+    const vector<Byte> bank0 = { 0xA9, 0x01, 0x4C, 0x00, 0x80 }; // LDA #$01, JMP $8000
+    const vector<Byte> bank1 = { 0xA9, 0x02, 0x4C, 0x00, 0x80 }; // LDA #$02, JMP $8000
+    copy(bank0.begin(), bank0.end(), banked.Data.begin() + BASE_PC);
+
+    Cpu runner("6502", &banked);
+    runner.PC = BASE_PC;
+    runner.FastPath = true;
+    Trace(runner, 50);
+    EXPECT_EQ(0x01, runner.A);
+
+    copy(bank1.begin(), bank1.end(), banked.Data.begin() + BASE_PC);
+    ++banked.Generation;
+    Trace(runner, 50);
+    EXPECT_EQ(0x02, runner.A);
+}
+
+TEST_F(CpuTestFastPath, BankSwitchDropsSwitchedPages) {
+    // The operand of the last instruction below $C000 is in the switched
+    // bank, decoded code of the fixed bank is kept
+    PagedBankedMemory paged;
+    paged.Data.fill(0xEA);
+    const vector<Byte> fixed = { 0x4C, 0xFF, 0xBF }; // JMP $BFFF
+    copy(fixed.begin(), fixed.end(), paged.Data.begin() + BASE_PC);
+    paged.Data[0xBFFF] = 0xA2;                        // LDX #
+    for (Byte bank = 0; bank < 2; ++bank) {
+        paged.Banks[bank].fill(0xEA);
+        const vector<Byte> code = { Byte(bank + 1), 0x4C, 0x00, 0x80 }; // JMP $8000
+        copy(code.begin(), code.end(), paged.Banks[bank].begin());
+    }
+    paged.Switch(0);
+
+    Cpu runner("6502", &paged);
+    runner.PC = BASE_PC;
+    runner.FastPath = true;
+    Trace(runner, 50);
+    EXPECT_EQ(0x01, runner.X);
+
+    paged.Switch(1);
+    Trace(runner, 50);
+    EXPECT_EQ(0x02, runner.X);
+
+    paged.Switch(0);
+    Trace(runner, 50);
+    EXPECT_EQ(0x01, runner.X);
+}
@@ -309,6 +309,54 @@ TEST_F(Mapper001Test, CHR1Register) {
     }
 }
 
+TEST_F(Mapper001Test, CHRPages) {
+    mmc1.ChrBanks.resize(4);
+    mmc1.HasChrRam = false;
+    mmc1.ChrMode = Mapper_001::CHRBankingMode::TwoBanks;
+
+    const auto generation = mmc1.ChrGeneration;
+    mmc1.WriteCHR0(1);
+    mmc1.WriteCHR1(3);
+    EXPECT_NE(generation, mmc1.ChrGeneration);
+
+    PageTable pages;
+    mmc1.MapPpuPages(pages);
+    EXPECT_EQ(mmc1.ChrBanks[1].data(), pages.Read[0]);
+    EXPECT_EQ(mmc1.ChrBanks[3].data() + 0x0C00, pages.Read[7]);
+    EXPECT_EQ(nullptr, pages.Write[0]);
+
+    mmc1.HasChrRam = true;
+    mmc1.MapPpuPages(pages);
+    EXPECT_EQ(mmc1.ChrRam.data() + 0x1000, pages.Read[4]);
+    EXPECT_EQ(mmc1.ChrRam.data() + 0x1000, pages.Write[4]);
+}
+
+TEST_F(Mapper001Test, CHRGeneration) {
+    // Rewriting the registers with the banks seen keeps the pattern pages
+    mmc1.ChrBanks.resize(4);
+    mmc1.WriteControl(0x10);
+    mmc1.WriteCHR0(1);
+    mmc1.WriteCHR1(2);
+
+    const auto generation = mmc1.ChrGeneration;
+    mmc1.WriteControl(0x10);
+    mmc1.WriteCHR0(1);
+    mmc1.WriteCHR1(2);
+    EXPECT_EQ(generation, mmc1.ChrGeneration);
+
+    mmc1.WriteCHR0(3);
+    EXPECT_NE(generation, mmc1.ChrGeneration);
+
+    const auto bank1 = mmc1.ChrGeneration;
+    mmc1.WriteCHR1(0);
+    EXPECT_NE(bank1, mmc1.ChrGeneration);
+
+    // One 8K bank
+    const auto mode = mmc1.ChrGeneration;
+    mmc1.WriteControl(0x00);
+    EXPECT_NE(mode, mmc1.ChrGeneration);
+}
+
 TEST_F(Mapper001Test, PRGRegister) {
     // Include mirroring for banks too high
     mmc1.PrgBanks.resize(4);
@@ -358,6 +406,31 @@ TEST_F(Mapper001Test, PRGRegister) {
     }
 }
 
+TEST_F(Mapper001Test, PRGGeneration) {
+    // Rewriting the registers with the banks seen keeps the decoded code
+    mmc1.PrgBanks.resize(4);
+    mmc1.WriteControl(0x0C);
+    mmc1.WritePRG(0x01);
+
+    const auto generation = mmc1.PrgGeneration;
+    mmc1.WriteControl(0x0C);
+    mmc1.WritePRG(0x01);
+    EXPECT_EQ(generation, mmc1.PrgGeneration);
+
+    mmc1.WritePRG(0x02);
+    EXPECT_NE(generation, mmc1.PrgGeneration);
+
+    // PRG RAM disabled
+    const auto ram = mmc1.PrgGeneration;
+    mmc1.WritePRG(0x12);
+    EXPECT_NE(ram, mmc1.PrgGeneration);
+
+    // 16K bank switched at $C000
+    const auto mode = mmc1.PrgGeneration;
+    mmc1.WriteControl(0x08);
+    EXPECT_NE(mode, mmc1.PrgGeneration);
+}
+
 TEST_F(Mapper001Test, CHR_8KBanks) {
     mmc1.ChrMode = Mapper_001::CHRBankingMode::OneBank;
     
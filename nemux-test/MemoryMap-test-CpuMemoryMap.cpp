@@ -18,6 +18,8 @@ struct MonitoredCpu {
 };
 
 struct MonitoredApu : public Apu<nullptr_t> {
+    void Sync() {}
+
     MOCK_CONST_METHOD0(ReadStatus, Byte());
 
     MOCK_METHOD1(WritePulse1Control, void(const Byte value));
@@ -47,7 +49,7 @@ struct MonitoredApu : public Apu<nullptr_t> {
     MOCK_METHOD1(WriteCommonControl, void(const Byte value));
 };
 
-struct MonitoredPpu : public Ppu {
+struct MonitoredPpu : public Ppu<> {
     MOCK_METHOD1(WriteControl1, void(Byte value));
     MOCK_METHOD1(WriteControl2, void(Byte value));
     MOCK_METHOD0(ReadStatus, Byte());
@@ -68,6 +70,21 @@ struct MonitoredNesMapper : public NesMapper {
     MOCK_METHOD2(SetPpuAt, void(const Word address, const Byte value));
 };
 
+// Serves $8000-$BFFF from one of two banks through the page table
+struct PagedNesMapper : public MonitoredNesMapper {
+    std::array<std::array<Byte, 0x4000>, 2> Banks;
+    size_t Bank = 0;
+
+    void MapCpuPages(PageTable & pages) override {
+        pages.MapRead(0x8000, 0x4000, Banks[Bank].data());
+    }
+
+    void SwitchBank(const Word /*address*/, const Byte value) {
+        Bank = value;
+        ++PrgGeneration;
+    }
+};
+
 struct MonitoredControllers : public Controllers {
     MOCK_METHOD0(ReadP1, Byte());
     MOCK_METHOD0(ReadP2, Byte());
@@ -334,3 +351,36 @@ TEST_F(CpuMemoryMapTest, APU_Registers) {
         cpumap.GetByteAt(0x4015);
     }
 }
+
+TEST_F(CpuMemoryMapTest, Pages_IOGoesThroughHandlers) {
+    const auto pages = cpumap.DirectPages();
+    ASSERT_NE(nullptr, pages);
+    for (Word address = 0x0000; address < 0x2000; address += PageTable::PAGE_SIZE) {
+        EXPECT_EQ(cpumap.RAM.data() + (address & 0x07FF), pages->Read[PageTable::Page(address)]);
+        EXPECT_EQ(cpumap.RAM.data() + (address & 0x07FF), pages->Write[PageTable::Page(address)]);
+    }
+    for (Word address = 0x2000; address < 0x4400; address += PageTable::PAGE_SIZE) {
+        EXPECT_EQ(nullptr, pages->Read[PageTable::Page(address)]);
+        EXPECT_EQ(nullptr, pages->Write[PageTable::Page(address)]);
+    }
+}
+
+TEST_F(CpuMemoryMapTest, Pages_CartridgeBanks) {
+    PagedNesMapper paged;
+    paged.Banks[0].fill(0x11);
+    paged.Banks[1].fill(0x22);
+    CpuMemoryMap<MonitoredCpu, MonitoredPpu, MonitoredControllers, MonitoredApu> map(&cpu, &apu, &ppu, &paged, &controllers);
+    map.MapCartridge();
+
+    EXPECT_CALL(paged, GetCpuAt(0x8000)).Times(0);
+    EXPECT_EQ(0x11, map.GetByteAt(0x8000));
+
+    EXPECT_CALL(paged, SetCpuAt(0x8000, 0x01))
+        .WillOnce(::testing::Invoke(&paged, &PagedNesMapper::SwitchBank));
+    map.SetByteAt(0x8000, 0x01);
+    EXPECT_EQ(0x22, map.GetByteAt(0xBFFF));
+
+    // Not mapped by the cartridge
+    EXPECT_CALL(paged, GetCpuAt(0xC000)).WillOnce(::testing::Return(0x33));
+    EXPECT_EQ(0x33, map.GetByteAt(0xC000));
+}
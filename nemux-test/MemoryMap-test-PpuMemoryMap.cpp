@@ -21,6 +21,22 @@ struct MonitoredNesMapper : public NesMapper {
     MOCK_METHOD2(SetPpuAt, void(const Word address, const Byte value));
 };
 
+struct PagedChrMapper : public MonitoredNesMapper {
+    std::array<std::array<Byte, 0x1000>, 2> Banks;
+    std::array<Byte, 0x1000> Ram;
+    size_t Bank = 0;
+
+    void MapPpuPages(PageTable & pages) override {
+        pages.MapRead(0x0000, 0x1000, Banks[Bank].data());
+        pages.MapReadWrite(0x1000, 0x1000, Ram.data());
+    }
+
+    void SwitchBank(const size_t bank) {
+        Bank = bank;
+        ++ChrGeneration;
+    }
+};
+
 struct PpuMemoryMapTest : public ::testing::Test {
     MonitoredPalette palette;
     MonitoredNesMapper mapper;
@@ -104,3 +120,32 @@ TEST_F(PpuMemoryMapTest, Mapper_SetNametable) {
         ppumap.SetByteAt(0x2000, 0);
     }
 }
+
+TEST_F(PpuMemoryMapTest, Pages_ChrBanks) {
+    PagedChrMapper paged;
+    paged.Banks[0].fill(0x11);
+    paged.Banks[1].fill(0x22);
+    paged.Ram.fill(0x00);
+    PpuMemoryMap<MonitoredPalette, PagedChrMapper> map(&palette, &paged);
+
+    EXPECT_CALL(paged, GetPpuAt(_)).Times(0);
+    EXPECT_CALL(paged, SetPpuAt(_, _)).Times(0);
+    EXPECT_EQ(0x11, map.GetByteAt(0x0000));
+    paged.SwitchBank(1);
+    EXPECT_EQ(0x22, map.GetByteAt(0x0FFF));
+
+    // CHR-RAM writes are seen by the next fetch, ROM pages stay read only
+    map.SetByteAt(0x1234, 0x33);
+    EXPECT_EQ(0x33, paged.Ram[0x0234]);
+    EXPECT_EQ(0x33, map.GetByteAt(0x1234));
+}
+
+TEST_F(PpuMemoryMapTest, Pages_RomWritesGoToMapper) {
+    PagedChrMapper paged;
+    paged.Banks[0].fill(0x11);
+    PpuMemoryMap<MonitoredPalette, PagedChrMapper> map(&palette, &paged);
+
+    EXPECT_CALL(paged, SetPpuAt(0x0010, 0x44));
+    map.SetByteAt(0x0010, 0x44);
+    EXPECT_EQ(0x11, map.GetByteAt(0x0010));
+}
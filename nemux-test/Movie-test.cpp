@@ -0,0 +1,295 @@
+/*
+ * Movie-test.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: scorder
+ */
+
+#include "gtest/gtest.h"
+
+#include "Movie.h"
+
+#include <array>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct MovieConsole {
+    Controllers ctrl;
+    int Resets = 0;
+    void Reset() { ++Resets; }
+};
+
+struct MovieTest : public ::testing::Test {
+    MovieConsole nes;
+
+    static movie::Header TestHeader(const Word flags = 0) {
+        movie::Header header;
+        header.Flags = flags;
+        header.Mapper = 1;
+        header.RomSha1 = Sha1::Of("rom");
+        header.RomPath = "roms/test.nes";
+        return header;
+    }
+
+    static movie::Picture TestPicture() {
+        movie::Picture picture(FRAME_WIDTH * FRAME_HEIGHT, 0x0F);
+        picture[3] = 0x130;
+        picture[FRAME_WIDTH * 100 + 7] = 0x16;
+        return picture;
+    }
+};
+
+TEST(Hash, Sha1) {
+    const Sha1::Digest abc = {{
+        0xa9, 0x99, 0x3e, 0x36, 0x47, 0x06, 0x81, 0x6a, 0xba, 0x3e,
+        0x25, 0x71, 0x78, 0x50, 0xc2, 0x6c, 0x9c, 0xd0, 0xd8, 0x9d }};
+    EXPECT_EQ(abc, Sha1::Of("abc"));
+
+    // Padding spills into a second block
+    const Sha1::Digest two = {{
+        0x84, 0x98, 0x3e, 0x44, 0x1c, 0x3b, 0xd2, 0x6e, 0xba, 0xae,
+        0x4a, 0xa1, 0xf9, 0x51, 0x29, 0xe5, 0xe5, 0x46, 0x70, 0xf1 }};
+    EXPECT_EQ(two, Sha1::Of("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"));
+}
+
+TEST(Hash, Fnv1a) {
+    Fnv1a hash;
+    EXPECT_EQ(14695981039346656037ULL, hash.Value);
+    const Byte a = 'a';
+    hash.Add(&a, 1);
+    EXPECT_EQ(0xaf63dc4c8601ec8cULL, hash.Value);
+}
+
+TEST(Hash, Xxh64) {
+    EXPECT_EQ(0xef46db3751d8e999ULL, Xxh64::Of("", 0));
+    EXPECT_EQ(0xd24ec4f1a98c6e5bULL, Xxh64::Of("a", 1));
+    EXPECT_EQ(0x44bc2cf5ad770999ULL, Xxh64::Of("abc", 3));
+    // Long enough for the four lanes
+    const std::string spam = "Nobody inspects the spammish repetition";
+    EXPECT_EQ(0xfbcea83c8a378bf1ULL, Xxh64::Of(spam.data(), spam.size()));
+    EXPECT_NE(Xxh64::Of(spam.data(), spam.size()), Xxh64::Of(spam.data(), spam.size(), 1));
+
+    const std::array<Word, 3> words = {{ 0x0201, 0x0403, 0x0605 }};
+    const Byte bytes[] = { 1, 2, 3, 4, 5, 6 };
+    EXPECT_EQ(Xxh64::Of(bytes, sizeof(bytes)), Xxh64::Of(words));
+}
+
+TEST_F(MovieTest, PackUnpack) {
+    std::vector<Byte> data(300, 0x0F);
+    data[0] = 1;
+    data[1] = 2;
+    data[150] = 3;
+    const auto packed = movie::Pack(data);
+    EXPECT_GT(size_t(20), packed.size());
+    EXPECT_EQ(data, movie::Unpack(packed));
+
+    std::vector<Byte> literal;
+    for (int i = 0; i < 200; ++i) literal.push_back(Byte(i));
+    EXPECT_EQ(literal, movie::Unpack(movie::Pack(literal)));
+    EXPECT_EQ(std::vector<Byte>(), movie::Unpack(movie::Pack(std::vector<Byte>())));
+}
+
+TEST_F(MovieTest, Unpack_Truncated) {
+    EXPECT_THROW(movie::Unpack({ 5, 1, 2 }), invalid_format);
+    EXPECT_THROW(movie::Unpack({ 0xFE }), invalid_format);
+}
+
+TEST_F(MovieTest, Varint) {
+    std::stringstream stream;
+    movie::WriteVarint(stream, 0);
+    movie::WriteVarint(stream, 127);
+    movie::WriteVarint(stream, 128);
+    movie::WriteVarint(stream, 0x123456789ULL);
+    EXPECT_EQ(size_t(1 + 1 + 2 + 5), stream.str().size());
+    EXPECT_EQ(0U, movie::ReadVarint(stream));
+    EXPECT_EQ(127U, movie::ReadVarint(stream));
+    EXPECT_EQ(128U, movie::ReadVarint(stream));
+    EXPECT_EQ(0x123456789ULL, movie::ReadVarint(stream));
+    EXPECT_THROW(movie::ReadVarint(stream), invalid_format);
+}
+
+TEST_F(MovieTest, Header) {
+    std::stringstream stream;
+    {
+        movie::Writer writer(stream, TestHeader());
+    }
+    EXPECT_TRUE(movie::IsMovie(stream));
+    movie::Player player(stream);
+    EXPECT_FALSE(player.IsLegacy);
+    EXPECT_EQ(movie::VERSION, player.MovieHeader.Version);
+    EXPECT_EQ(1, player.MovieHeader.Mapper);
+    EXPECT_EQ(Sha1::Of("rom"), player.MovieHeader.RomSha1);
+    EXPECT_EQ("roms/test.nes", player.MovieHeader.RomPath);
+    EXPECT_FALSE(player.PlayFrame(nes));
+}
+
+TEST_F(MovieTest, Header_NewerVersion) {
+    std::stringstream stream;
+    auto header = TestHeader();
+    header.Version = movie::VERSION + 1;
+    movie::Writer(stream, header).Close();
+    EXPECT_THROW(movie::Player player(stream), unsupported_format);
+}
+
+TEST_F(MovieTest, Input_RunLength) {
+    std::stringstream stream;
+    {
+        movie::Writer writer(stream, TestHeader());
+        for (int i = 0; i < 1000; ++i) writer.EndFrame(0x00);
+        for (int i = 0; i < 3; ++i) writer.EndFrame(0x20);
+        writer.EndFrame(0x81);
+    }
+    const auto size = stream.str().size();
+    movie::Player player(stream);
+    EXPECT_EQ(size - (3 * 3 + 1 + 1), size_t(stream.tellg()));
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_TRUE(player.PlayFrame(nes));
+        EXPECT_EQ(0x00, replay::GetP1State(nes.ctrl));
+    }
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(player.PlayFrame(nes));
+        EXPECT_EQ(0x20, replay::GetP1State(nes.ctrl));
+    }
+    EXPECT_TRUE(player.PlayFrame(nes));
+    EXPECT_EQ(0x81, replay::GetP1State(nes.ctrl));
+    EXPECT_FALSE(player.PlayFrame(nes));
+    EXPECT_EQ(0, nes.Resets);
+}
+
+TEST_F(MovieTest, CheckAndReset) {
+    const auto picture = TestPicture();
+    const auto checkpoint = movie::CheckpointOf(picture);
+    std::stringstream stream;
+    {
+        movie::Writer writer(stream, TestHeader());
+        writer.EndFrame(0x00);
+        writer.EndFrame(0x00, &checkpoint, true);
+        writer.EndFrame(0x00);
+    }
+    movie::Player player(stream);
+    int checks = 0;
+    auto check = [&](const movie::Checkpoint & c) {
+        ++checks;
+        EXPECT_EQ(checkpoint.Hash, c.Hash);
+        EXPECT_TRUE(c.Pixels.empty());
+        EXPECT_TRUE(c.Matches(picture));
+        EXPECT_FALSE(c.Matches(movie::Picture(picture.size(), 0x0F)));
+    };
+    EXPECT_TRUE(player.PlayFrame(nes, check));
+    EXPECT_EQ(0, checks);
+    EXPECT_TRUE(player.PlayFrame(nes, check));
+    EXPECT_EQ(1, checks);
+    EXPECT_EQ(1, nes.Resets);
+    EXPECT_TRUE(player.PlayFrame(nes, check));
+    EXPECT_FALSE(player.PlayFrame(nes, check));
+    EXPECT_EQ(1, checks);
+    EXPECT_EQ(1, nes.Resets);
+}
+
+TEST_F(MovieTest, FrameDumps) {
+    const auto picture = TestPicture();
+    const auto checkpoint = movie::CheckpointOf(picture);
+    std::stringstream stream;
+    {
+        movie::Writer writer(stream, TestHeader(movie::FrameDumps));
+        writer.EndFrame(0x00, &checkpoint);
+    }
+    EXPECT_GT(size_t(2000), stream.str().size());
+    movie::Player player(stream);
+    int checks = 0;
+    EXPECT_TRUE(player.PlayFrame(nes, [&](const movie::Checkpoint & c) {
+        ++checks;
+        EXPECT_EQ(checkpoint.Hash, c.Hash);
+        EXPECT_EQ(picture, c.Pixels);
+    }));
+    EXPECT_EQ(1, checks);
+    EXPECT_FALSE(player.PlayFrame(nes));
+}
+
+TEST_F(MovieTest, FrameDumps_WithoutPicture) {
+    std::stringstream stream;
+    movie::Writer writer(stream, TestHeader(movie::FrameDumps));
+    movie::Checkpoint checkpoint;
+    EXPECT_THROW(writer.EndFrame(0x00, &checkpoint), invalid_format);
+}
+
+TEST_F(MovieTest, PictureOf) {
+    std::array<Word, VIDEO_SIZE> frame;
+    frame.fill(0x0F);
+    // Pixel 5 of line 2 comes out on dot 6
+    frame[2 * VIDEO_WIDTH + 6] = 0x30;
+    const auto picture = movie::PictureOf(frame);
+    EXPECT_EQ(size_t(FRAME_WIDTH * FRAME_HEIGHT), picture.size());
+    EXPECT_EQ(0x30, picture[2 * FRAME_WIDTH + 5]);
+
+    replay::FrameDump dump(VIDEO_SIZE, 0x0F);
+    dump[2 * VIDEO_WIDTH + 5] = 0x30;
+    EXPECT_EQ(picture, movie::PictureOf(dump));
+}
+
+TEST_F(MovieTest, HashOf_Frame) {
+    std::array<Word, VIDEO_SIZE> frame;
+    frame.fill(0x0F);
+    frame[100 * VIDEO_WIDTH + 50] = 0x130;
+    const auto picture = movie::PictureOf(frame);
+    EXPECT_EQ(movie::HashOf(picture), movie::HashOf(frame));
+    EXPECT_EQ(movie::HashOf(picture, 1), movie::HashOf(frame, 1));
+    EXPECT_NE(movie::HashOf(picture), movie::HashOf(picture, 1));
+
+    // Dots outside the picture are not hashed
+    const auto hash = movie::HashOf(frame);
+    frame[100 * VIDEO_WIDTH] = 0x30;
+    frame[VIDEO_SIZE - 1] = 0x30;
+    EXPECT_EQ(hash, movie::HashOf(frame));
+    frame[100 * VIDEO_WIDTH + 51] = 0x30;
+    EXPECT_NE(hash, movie::HashOf(frame));
+}
+
+TEST_F(MovieTest, CheckVersion1) {
+    const auto picture = TestPicture();
+    std::stringstream stream;
+    {
+        auto header = TestHeader();
+        header.Version = 1;
+        movie::Writer writer(stream, header);
+        movie::Checkpoint checkpoint;
+        checkpoint.Hash = movie::HashOf(picture, 1);
+        writer.EndFrame(0x00, &checkpoint);
+    }
+    movie::Player player(stream);
+    int checks = 0;
+    EXPECT_TRUE(player.PlayFrame(nes, [&](const movie::Checkpoint & c) {
+        ++checks;
+        EXPECT_EQ(1, c.Version);
+        EXPECT_TRUE(c.Matches(picture));
+    }));
+    EXPECT_EQ(1, checks);
+}
+
+TEST_F(MovieTest, Legacy) {
+    std::string dump(VIDEO_SIZE, 0x0F);
+    dump[VIDEO_WIDTH + 3] = 0x30;
+    std::istringstream stream(std::string("dir\\rom.nes") + '\0'
+        + char(replay::FrameStart) + char(replay::Player_1) + char(0x20) + char(replay::FrameEnd)
+        + char(replay::FrameStart) + char(replay::CheckFrame) + dump + char(replay::Reset) + char(replay::FrameEnd));
+    EXPECT_FALSE(movie::IsMovie(stream));
+    movie::Player player(stream);
+    EXPECT_TRUE(player.IsLegacy);
+    EXPECT_EQ("dir\\rom.nes", player.MovieHeader.RomPath);
+
+    movie::Picture expected(FRAME_WIDTH * FRAME_HEIGHT, 0x0F);
+    expected[FRAME_WIDTH + 3] = 0x30;
+    int checks = 0;
+    auto check = [&](const movie::Checkpoint & c) {
+        ++checks;
+        EXPECT_TRUE(c.Matches(expected));
+        EXPECT_EQ(expected, c.Pixels);
+    };
+    EXPECT_TRUE(player.PlayFrame(nes, check));
+    EXPECT_EQ(0x20, replay::GetP1State(nes.ctrl));
+    EXPECT_TRUE(player.PlayFrame(nes, check));
+    EXPECT_EQ(1, checks);
+    EXPECT_EQ(1, nes.Resets);
+    EXPECT_FALSE(player.PlayFrame(nes, check));
+}
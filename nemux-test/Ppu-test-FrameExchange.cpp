@@ -0,0 +1,88 @@
+/*
+ * Ppu-test-FrameExchange.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: scorder
+ */
+
+#include "gtest/gtest.h"
+
+#include "FrameExchange.h"
+#include "Ppu.h"
+
+#include <thread>
+#include <vector>
+
+TEST(FrameExchangeTest, NothingToTakeBeforePublish) {
+    FrameExchange<int> frames;
+    EXPECT_FALSE(frames.Take());
+    EXPECT_EQ(0u, frames.Published);
+}
+
+TEST(FrameExchangeTest, TakesLatestFrame) {
+    FrameExchange<int> frames;
+    frames.Back() = 1;
+    frames.Publish();
+    frames.Back() = 2;
+    frames.Publish();
+    EXPECT_EQ(2u, frames.Published);
+    EXPECT_EQ(1u, frames.Dropped);
+
+    ASSERT_TRUE(frames.Take());
+    EXPECT_EQ(2, frames.Front());
+    EXPECT_FALSE(frames.Take());
+    EXPECT_EQ(2, frames.Front());
+}
+
+TEST(FrameExchangeTest, BackIsNeverFront) {
+    FrameExchange<int> frames;
+    for (int i = 0; i < 20; ++i) {
+        frames.Back() = i;
+        frames.Publish();
+        if (i % 3 == 0) {
+            ASSERT_TRUE(frames.Take());
+            EXPECT_EQ(i, frames.Front());
+        }
+        EXPECT_NE(&frames.Back(), &frames.Front());
+    }
+}
+
+TEST(FrameExchangeTest, ScreensSwapInWithoutCopy) {
+    // The PPU draws straight into the exchange, its screen changes places
+    // with the back frame
+    FrameExchange<IndexedFrame> frames;
+    IndexedFrame screen;
+    screen.Pixels[0] = 0x2A;
+    const auto drawn = screen.Pixels.data();
+    std::swap(screen, frames.Back());
+    frames.Publish();
+
+    ASSERT_TRUE(frames.Take());
+    EXPECT_EQ(drawn, frames.Front().Pixels.data());
+    EXPECT_EQ(Byte(0x2A), frames.Front().Pixels[0]);
+}
+
+TEST(FrameExchangeTest, ProducerAndConsumerThreads) {
+    // Every frame taken is whole and newer than the one before
+    static constexpr int COUNT = 20000;
+    FrameExchange<std::vector<int>> frames;
+
+    std::thread producer([&frames]() {
+        for (int i = 1; i <= COUNT; ++i) {
+            frames.Back().assign(256, i);
+            frames.Publish();
+        }
+    });
+
+    int last = 0;
+    while (last < COUNT) {
+        if (!frames.Take()) continue;
+        const auto & frame = frames.Front();
+        ASSERT_EQ(256u, frame.size());
+        ASSERT_GT(frame[0], last);
+        for (const auto value : frame) ASSERT_EQ(frame[0], value);
+        last = frame[0];
+    }
+    producer.join();
+    EXPECT_EQ(size_t(COUNT), frames.Published);
+}
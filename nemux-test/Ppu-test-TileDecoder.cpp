@@ -0,0 +1,60 @@
+/*
+ * Ppu-test-TileDecoder.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: scorder
+ */
+
+#include "gtest/gtest.h"
+
+#include "TileDecoder.h"
+
+#include <array>
+
+typedef void (*Decoder)(const Byte, const Byte, const Byte, const Byte, Byte *);
+
+// Every pattern pair with a few attribute pairs against one bit at a time
+void ExpectDecodes(const Decoder decode) {
+    const Byte attributes[][2] = { { 0x00, 0x00 }, { 0xFF, 0x00 }, { 0x00, 0xFF }, { 0xA5, 0x3C } };
+    for (const auto & at : attributes) {
+        for (int lo = 0; lo < 256; ++lo) {
+            for (int hi = 0; hi < 256; ++hi) {
+                std::array<Byte, tile::WIDTH> row;
+                decode(Byte(lo), Byte(hi), at[0], at[1], row.data());
+                for (size_t i = 0; i < tile::WIDTH; ++i) {
+                    const auto bit = 7 - i;
+                    const Byte expected = ((lo >> bit) & 0x01) | (((hi >> bit) & 0x01) << 1)
+                        | (((at[0] >> bit) & 0x01) << 2) | (((at[1] >> bit) & 0x01) << 3);
+                    ASSERT_EQ(expected, row[i]) << "lo " << lo << " hi " << hi << " pixel " << i;
+                }
+            }
+        }
+    }
+}
+
+TEST(TileDecoder, Spread) {
+    EXPECT_EQ(0x0000000000000000ULL, tile::Spread(0x00));
+    EXPECT_EQ(0x0101010101010101ULL, tile::Spread(0xFF));
+    EXPECT_EQ(0x0000000000000001ULL, tile::Spread(0x80));
+    EXPECT_EQ(0x0100000000000000ULL, tile::Spread(0x01));
+}
+
+TEST(TileDecoder, Scalar) {
+    ExpectDecodes(tile::DecodeScalar);
+}
+
+#if defined(TILE_DECODER_SSE2)
+TEST(TileDecoder, Sse2) {
+    ExpectDecodes(tile::DecodeSse2);
+}
+#endif
+
+#if defined(TILE_DECODER_AVX2)
+TEST(TileDecoder, Avx2) {
+    ExpectDecodes(tile::DecodeAvx2);
+}
+#endif
+
+TEST(TileDecoder, Decode) {
+    ExpectDecodes(tile::Decode);
+}
@@ -15,7 +15,7 @@ using namespace std;
 
 struct PpuTest : public ::testing::Test {
     MemoryBlock<0x3000> ppumap;
-    Ppu ppu;
+    Ppu<> ppu;
     
     PpuTest() : ppu(&ppumap) {}
 };
@@ -514,8 +514,11 @@ TEST_F(PpuTest, NMI_StopOnStatusRead) {
 
     EXPECT_EQ(true, ppu.NMIActive);
 
+    // The NMI line follows VBlank 2 dots late
     ppu.ReadStatus();
     ppu.Tick();
+    EXPECT_EQ(true, ppu.NMIActive);
+    ppu.Tick();
     EXPECT_EQ(false, ppu.NMIActive);
 }
 
@@ -678,3 +681,161 @@ TEST_F(PpuTest, SpritePriorityMultiplexer) {
     EXPECT_EQ(background, ppu.SpriteMultiplexer(background, foreground, true));
     EXPECT_EQ(foreground, ppu.SpriteMultiplexer(background, foreground, false));
 }
+
+TEST_F(PpuTest, ScheduleDefersDots) {
+    ppu.Schedule(3);
+    const auto ticks = ppu.FrameTicks;
+    ppu.Schedule(3);
+    ppu.Schedule(3);
+    EXPECT_EQ(ticks, ppu.FrameTicks);
+    EXPECT_EQ(6u, ppu.PendingDots);
+
+    ppu.Sync();
+    EXPECT_EQ(ticks + 6, ppu.FrameTicks);
+    EXPECT_EQ(0u, ppu.PendingDots);
+}
+
+TEST_F(PpuTest, ScheduleKeepsNMIInStep) {
+    const size_t cycles = VIDEO_SIZE / 3 + 10;
+    vector<bool> nmi;
+    vector<size_t> frames;
+    ppu.WriteControl1(0x80);
+    for (size_t cycle = 0; cycle < cycles; ++cycle) {
+        ppu.Tick();
+        ppu.Tick();
+        ppu.Tick();
+        nmi.push_back(ppu.NMIActive);
+        frames.push_back(ppu.FrameCount);
+    }
+
+    Ppu<> scheduled(&ppumap);
+    scheduled.WriteControl1(0x80);
+    for (size_t cycle = 0; cycle < cycles; ++cycle) {
+        scheduled.Schedule(3);
+        ASSERT_EQ(nmi[cycle], scheduled.NMIActive) << "Cycle " << cycle;
+        ASSERT_EQ(frames[cycle], scheduled.FrameCount) << "Cycle " << cycle;
+    }
+}
+
+TEST_F(PpuTest, InstancesTickIndependently) {
+    // Second PPU a few dots behind so VBlank changes while the other one
+    // holds its previous level
+    const size_t dots = VIDEO_SIZE + 10;
+    const size_t lag = 2;
+    vector<bool> nmi;
+    ppu.WriteControl1(0x80);
+    for (size_t dot = 0; dot < dots + lag; ++dot) {
+        ppu.Tick();
+        nmi.push_back(ppu.NMIActive);
+    }
+
+    Ppu<> first(&ppumap);
+    Ppu<> second(&ppumap);
+    first.WriteControl1(0x80);
+    second.WriteControl1(0x80);
+    for (size_t dot = 0; dot < lag; ++dot) first.Tick();
+    for (size_t dot = 0; dot < dots; ++dot) {
+        first.Tick();
+        second.Tick();
+        ASSERT_EQ(nmi[dot + lag], first.NMIActive) << "Dot " << dot;
+        ASSERT_EQ(nmi[dot], second.NMIActive) << "Dot " << dot;
+    }
+}
+
+TEST_F(PpuTest, TileSpansMatchDots) {
+    // Pseudo random tiles, name tables, palette and sprites, fine scroll so
+    // the pixels of a span come from two tiles
+    uint32_t seed = 12345;
+    auto random = [&seed]() { seed = seed * 1103515245 + 12345; return Byte(seed >> 16); };
+    for (Word address = 0; address < 0x3000; ++address) ppumap.SetByteAt(address, random());
+    auto setup = [](Ppu<> & p) {
+        p.FullFrame = true;
+        for (Byte i = 0; i < 0x20; ++i) p.PpuPalette.WriteAt(i, Byte(i * 3));
+        for (size_t i = 0; i < p.SprRam.size(); ++i) p.SprRam[i] = Byte(i * 37 + 11);
+        p.SprRam[0] = 20;
+        p.SprRam[3] = 100;
+        p.WriteControl1(0x90);
+        p.WriteScroll(0x23);
+        p.WriteScroll(0x45);
+        p.WriteControl2(0x1E);
+    };
+    setup(ppu);
+    Ppu<> spans(&ppumap);
+    setup(spans);
+
+    // Uneven steps so spans start anywhere in the owed dots
+    const size_t steps[] = { 3, 29, 1, 120, 8, 341 };
+    size_t dots = 0;
+    for (size_t i = 0; dots < 2 * VIDEO_SIZE; ++i) {
+        const auto step = steps[i % 6];
+        for (size_t dot = 0; dot < step; ++dot) ppu.Tick();
+        spans.PendingDots += step;
+        spans.CatchUp();
+        dots += step;
+        ASSERT_EQ(ppu.FrameTicks, spans.FrameTicks);
+        ASSERT_EQ(ppu.NMIActive, spans.NMIActive);
+        ASSERT_EQ(ppu.SpriteZeroHit, spans.SpriteZeroHit);
+    }
+    EXPECT_TRUE(ppu.Frame == spans.Frame);
+    EXPECT_TRUE(ppu.Screen == spans.Screen);
+
+    vector<Byte> dotState;
+    vector<Byte> spanState;
+    StateWriter dotWriter(dotState);
+    StateWriter spanWriter(spanState);
+    ppu.rp2c02.Serialize(dotWriter);
+    spans.rp2c02.Serialize(spanWriter);
+    EXPECT_EQ(dotState, spanState);
+}
+
+TEST_F(PpuTest, ScreenMatchesFrame) {
+    // Emphasis and greyscale switched in the middle of lines and frames
+    uint32_t seed = 54321;
+    auto random = [&seed]() { seed = seed * 1103515245 + 12345; return Byte(seed >> 16); };
+    for (Word address = 0; address < 0x3000; ++address) ppumap.SetByteAt(address, random());
+    for (Byte i = 0; i < 0x20; ++i) ppu.PpuPalette.WriteAt(i, Byte(i * 5));
+    ppu.FullFrame = true;
+    ppu.WriteControl1(0x10);
+    ppu.WriteControl2(0x1E);
+
+    const Byte masks[] = { 0x1E, 0x3F, 0xDE, 0x1E, 0x9F };
+    for (size_t i = 0; i < 2 * VIDEO_SIZE / 997; ++i) {
+        if (i % 7 == 6) ppu.WriteControl2(masks[(i / 7) % 5]);
+        ppu.PendingDots += 997;
+        ppu.CatchUp();
+    }
+
+    std::array<Word, FRAME_WIDTH> line;
+    for (size_t y = 0; y < FRAME_HEIGHT; ++y) {
+        ppu.Screen.Line(y, line.data());
+        for (size_t x = 0; x < FRAME_WIDTH; ++x) {
+            ASSERT_EQ(ppu.Frame[VIDEO_WIDTH * y + x + FRAME_DOT_OFFSET], line[x]) << "Pixel " << x << ", " << y;
+        }
+    }
+    EXPECT_GT(ppu.Screen.Modes.size(), size_t(1));
+    EXPECT_LT(ppu.Screen.Modes.size(), size_t(16));
+}
+
+TEST(IndexedFrame, ModesFromPixel) {
+    IndexedFrame frame;
+    std::fill(frame.Pixels.begin(), frame.Pixels.end(), Byte(0x21));
+    frame.SetMode(0, 0x0040);
+    frame.SetMode(10, 0x0040);
+    frame.SetMode(FRAME_WIDTH + 44, 0x0200);
+    ASSERT_EQ(size_t(2), frame.Modes.size());
+
+    std::array<Word, FRAME_WIDTH> line;
+    frame.Line(0, line.data());
+    EXPECT_EQ(Word(0x0061), line[FRAME_WIDTH - 1]);
+    frame.Line(1, line.data());
+    EXPECT_EQ(Word(0x0061), line[43]);
+    EXPECT_EQ(Word(0x0221), line[44]);
+    frame.Line(FRAME_HEIGHT - 1, line.data());
+    EXPECT_EQ(Word(0x0221), line[0]);
+
+    // Drawn again from the top
+    frame.SetMode(0, 0x0000);
+    ASSERT_EQ(size_t(1), frame.Modes.size());
+    frame.Line(1, line.data());
+    EXPECT_EQ(Word(0x0021), line[44]);
+}
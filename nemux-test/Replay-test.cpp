@@ -0,0 +1,89 @@
+/*
+ * Replay-test.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: scorder
+ */
+
+#include "gtest/gtest.h"
+
+#include "Replay.h"
+
+#include <array>
+#include <sstream>
+#include <string>
+
+struct ReplayConsole {
+    Controllers ctrl;
+    int Resets = 0;
+    void Reset() { ++Resets; }
+};
+
+struct ReplayTest : public ::testing::Test {
+    ReplayConsole nes;
+
+    static std::string Frame(const std::string & commands) {
+        return std::string(1, replay::FrameStart) + commands + std::string(1, replay::FrameEnd);
+    }
+};
+
+TEST_F(ReplayTest, ReadRomPath) {
+    std::istringstream movie(std::string("dir\\rom.nes") + '\0' + Frame(""));
+    EXPECT_EQ("dir\\rom.nes", replay::ReadRomPath(movie));
+    EXPECT_TRUE(replay::PlayFrame(movie, nes));
+    EXPECT_FALSE(replay::PlayFrame(movie, nes));
+}
+
+TEST_F(ReplayTest, PlayFrame_Player1) {
+    // Down is 0x20, a space, read as a raw byte
+    std::istringstream movie(Frame(std::string(1, replay::Player_1) + char(0x20))
+        + Frame(std::string(1, replay::Player_1) + char(0x81)));
+    EXPECT_TRUE(replay::PlayFrame(movie, nes));
+    EXPECT_EQ(0x20, replay::GetP1State(nes.ctrl));
+    EXPECT_TRUE(nes.ctrl.P1_Down);
+    EXPECT_TRUE(replay::PlayFrame(movie, nes));
+    EXPECT_EQ(0x81, replay::GetP1State(nes.ctrl));
+}
+
+TEST_F(ReplayTest, PlayFrame_Reset) {
+    std::istringstream movie(Frame(std::string(1, replay::Reset)));
+    EXPECT_TRUE(replay::PlayFrame(movie, nes));
+    EXPECT_EQ(1, nes.Resets);
+}
+
+TEST_F(ReplayTest, PlayFrame_CheckFrame) {
+    std::string dump(VIDEO_SIZE, 0x0F);
+    dump[VIDEO_WIDTH + 3] = 0x30;
+    std::istringstream movie(Frame(std::string(1, replay::CheckFrame) + dump + char(replay::Reset)));
+    int checks = 0;
+    EXPECT_TRUE(replay::PlayFrame(movie, nes, [&checks](const replay::FrameDump & d) {
+        ++checks;
+        EXPECT_EQ(size_t(VIDEO_SIZE), d.size());
+        EXPECT_EQ(0x30, d[VIDEO_WIDTH + 3]);
+    }));
+    EXPECT_EQ(1, checks);
+    EXPECT_EQ(1, nes.Resets);
+}
+
+TEST_F(ReplayTest, PlayFrame_Truncated) {
+    std::istringstream movie(std::string(1, replay::FrameStart) + char(replay::CheckFrame) + std::string(100, 0));
+    EXPECT_FALSE(replay::PlayFrame(movie, nes, [](const replay::FrameDump &) { FAIL(); }));
+}
+
+TEST_F(ReplayTest, FirstMismatch) {
+    std::array<Word, VIDEO_SIZE> frame;
+    frame.fill(0x0F);
+    replay::FrameDump dump(VIDEO_SIZE, 0x0F);
+    EXPECT_EQ(size_t(VIDEO_SIZE), replay::FirstMismatch(frame, dump));
+
+    // Outside the visible pixels
+    frame[0] = 0x30;
+    dump[FRAME_WIDTH] = 0x30;
+    EXPECT_EQ(size_t(VIDEO_SIZE), replay::FirstMismatch(frame, dump));
+
+    // Pixel 5 of line 2 comes out on dot 6
+    frame[2 * VIDEO_WIDTH + 6] = 0x30;
+    EXPECT_EQ(2 * VIDEO_WIDTH + 5, replay::FirstMismatch(frame, dump));
+    dump[2 * VIDEO_WIDTH + 5] = 0x30;
+    EXPECT_EQ(size_t(VIDEO_SIZE), replay::FirstMismatch(frame, dump));
+}
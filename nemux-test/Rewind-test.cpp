@@ -0,0 +1,137 @@
+/*
+ * Rewind-test.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: scorder
+ */
+
+#include "gtest/gtest.h"
+
+#include "Rewind.h"
+
+#include <vector>
+
+// Its state is a frame counter and bytes that each frame changes a little
+// according to the input, the size changes every frame
+struct RewindConsole {
+    Controllers ctrl;
+    uint32_t Frame = 0;
+    std::vector<Byte> Memory = std::vector<Byte>(3000, 0);
+
+    void RunUntilFrame() {
+        const Byte input = replay::GetP1State(ctrl);
+        Memory[(Frame * 37) % 2048] += Byte(input + 1);
+        Memory[2048 + Frame % 7] ^= input;
+        Memory.resize(3000 + Frame % 5);
+        ++Frame;
+    }
+
+    void SaveState(std::vector<Byte> & state) const {
+        state.assign(reinterpret_cast<const Byte *>(&Frame), reinterpret_cast<const Byte *>(&Frame) + sizeof(Frame));
+        state.insert(state.end(), Memory.begin(), Memory.end());
+    }
+
+    void LoadState(const std::vector<Byte> & state) {
+        std::copy(state.begin(), state.begin() + sizeof(Frame), reinterpret_cast<Byte *>(&Frame));
+        Memory.assign(state.begin() + sizeof(Frame), state.end());
+    }
+
+    std::vector<Byte> State() const {
+        std::vector<Byte> state;
+        SaveState(state);
+        return state;
+    }
+};
+
+struct RewindTest : public ::testing::Test {
+    RewindConsole nes;
+    // State at the end of every frame, the first one is before any frame
+    std::vector<std::vector<Byte>> states;
+
+    RewindTest() { states.push_back(nes.State()); }
+
+    void Run(Rewind & rewind, const int frames) {
+        for (int i = 0; i < frames; ++i) {
+            replay::SetP1State(nes.ctrl, Byte(nes.Frame * 13));
+            rewind.Record(nes);
+            nes.RunUntilFrame();
+            states.resize(nes.Frame);
+            states.push_back(nes.State());
+        }
+    }
+};
+
+TEST_F(RewindTest, Empty) {
+    Rewind rewind(1000, 4);
+    EXPECT_EQ(0U, rewind.Frames());
+    EXPECT_FALSE(rewind.StepBack(nes));
+    EXPECT_FALSE(rewind.Seek(nes, 1));
+}
+
+TEST_F(RewindTest, SeekEveryFrame) {
+    Rewind rewind(1 << 20, 4);
+    Run(rewind, 50);
+    EXPECT_EQ(50U, rewind.Frames());
+    EXPECT_EQ(0U, rewind.OldestFrame());
+    EXPECT_FALSE(rewind.Seek(nes, 51));
+    for (uint64_t frame = 51; frame-- > 0; ) {
+        ASSERT_TRUE(rewind.Seek(nes, frame));
+        EXPECT_EQ(frame, rewind.Frames());
+        EXPECT_EQ(states[frame], nes.State()) << "Frame " << frame;
+    }
+    EXPECT_FALSE(rewind.StepBack(nes));
+}
+
+TEST_F(RewindTest, SeekFar) {
+    Rewind rewind(1 << 20, 5);
+    Run(rewind, 100);
+    ASSERT_TRUE(rewind.Seek(nes, 23));
+    EXPECT_EQ(states[23], nes.State());
+    ASSERT_TRUE(rewind.Seek(nes, 3));
+    EXPECT_EQ(states[3], nes.State());
+}
+
+TEST_F(RewindTest, RecordAfterSeek) {
+    Rewind rewind(1 << 20, 4);
+    Run(rewind, 30);
+    ASSERT_TRUE(rewind.Seek(nes, 17));
+    Run(rewind, 20);
+    EXPECT_EQ(37U, rewind.Frames());
+    for (const uint64_t frame : { 36, 25, 18, 17, 9 }) {
+        ASSERT_TRUE(rewind.Seek(nes, frame));
+        EXPECT_EQ(states[frame], nes.State()) << "Frame " << frame;
+    }
+}
+
+TEST_F(RewindTest, DeltasArePacked) {
+    Rewind rewind(1 << 20, 1);
+    Run(rewind, 10);
+    EXPECT_GT(size_t(40), rewind.LastDeltaSize);
+    EXPECT_GT(nes.State().size() + 10 * 50, rewind.BytesUsed());
+}
+
+TEST_F(RewindTest, RingDropsOldest) {
+    Rewind rewind(200, 2);
+    Run(rewind, 300);
+    EXPECT_LT(1U, rewind.OldestFrame());
+    EXPECT_GE(rewind.Capacity + nes.State().size() + rewind.Interval, rewind.BytesUsed());
+    EXPECT_FALSE(rewind.Seek(nes, rewind.OldestFrame() - 1));
+    for (uint64_t frame = 300; frame >= rewind.OldestFrame(); --frame) {
+        ASSERT_TRUE(rewind.Seek(nes, frame));
+        EXPECT_EQ(states[frame], nes.State()) << "Frame " << frame;
+    }
+
+    // Keeps recording past the wrap after going back
+    Run(rewind, 300);
+    const auto frame = rewind.Frames() - 7;
+    ASSERT_TRUE(rewind.Seek(nes, frame));
+    EXPECT_EQ(states[frame], nes.State());
+}
+
+TEST_F(RewindTest, RingTooSmall) {
+    Rewind rewind(4, 4);
+    Run(rewind, 20);
+    EXPECT_EQ(16U, rewind.OldestFrame());
+    ASSERT_TRUE(rewind.Seek(nes, 16));
+    EXPECT_EQ(states[16], nes.State());
+}
@@ -0,0 +1,70 @@
+/*
+ * ThreadPool-test.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: scorder
+ */
+
+#include "gtest/gtest.h"
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST(ThreadPoolTest, RunsEveryJobOnce) {
+    ThreadPool pool(4);
+    std::vector<int> runs(100, 0);
+    std::vector<ThreadPool::Job> jobs;
+    for (auto & run : runs) jobs.push_back([&run]() { ++run; });
+    pool.Run(jobs);
+    for (const auto run : runs) EXPECT_EQ(1, run);
+}
+
+TEST(ThreadPoolTest, IdleWorkersStealJobs) {
+    // Round robin puts every slow job on the first worker
+    static constexpr size_t THREADS = 4;
+    ThreadPool pool(THREADS);
+    std::vector<std::thread::id> ranOn(4 * THREADS);
+    std::vector<ThreadPool::Job> jobs;
+    for (size_t i = 0; i < ranOn.size(); ++i) {
+        const bool slow = i % THREADS == 0;
+        auto & id = ranOn[i];
+        jobs.push_back([slow, &id]() {
+            if (slow) std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            id = std::this_thread::get_id();
+        });
+    }
+    pool.Run(jobs);
+    std::vector<std::thread::id> slowThreads;
+    for (size_t i = 0; i < ranOn.size(); i += THREADS) {
+        if (std::find(slowThreads.begin(), slowThreads.end(), ranOn[i]) == slowThreads.end()) {
+            slowThreads.push_back(ranOn[i]);
+        }
+    }
+    EXPECT_GT(slowThreads.size(), 1u);
+}
+
+TEST(ThreadPoolTest, RethrowsAfterAllJobsRan) {
+    ThreadPool pool(2);
+    std::atomic<int> runs(0);
+    std::vector<ThreadPool::Job> jobs;
+    for (int i = 0; i < 10; ++i) {
+        jobs.push_back([i, &runs]() {
+            ++runs;
+            if (i == 3) throw std::runtime_error("job failed");
+        });
+    }
+    EXPECT_THROW(pool.Run(jobs), std::runtime_error);
+    EXPECT_EQ(10, runs.load());
+}
+
+TEST(ThreadPoolTest, DefaultsToHardwareThreads) {
+    ThreadPool pool;
+    EXPECT_GE(pool.Threads, 1u);
+    pool.Run({});
+}
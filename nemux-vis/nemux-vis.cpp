@@ -7,6 +7,10 @@
 #include <sstream>
 #include <memory>
 #include <iterator>
+#include <array>
+#include <atomic>
+#include <exception>
+#include <thread>
 
 #include "SDL.h"
 
@@ -17,9 +21,11 @@
 #include "Mapper_3.h"
 #include "NsfFile.h"
 #include "Mapper_Nsf.h"
-#include "Cpu.h"
-#include "Ppu.h"
-#include "Controllers.h"
+#include "Machine.h"
+#include "Movie.h"
+#include "Rewind.h"
+#include "SpscRing.h"
+#include "FrameExchange.h"
 
 using std::boolalpha;
 using std::hex;
@@ -30,80 +36,6 @@ using std::endl;
 
 #undef main
 
-class Machine {
-public:
-    Controllers ctrl;
-    std::unique_ptr<NesMapper> mapper;
-    PpuMemoryMap<Palette> ppumap;
-    Ppu ppu;
-    Apu<Cpu> apu;
-    CpuMemoryMap<Cpu, Ppu, Controllers, Apu<Cpu>> cpumap;
-    Cpu cpu;
-
-    explicit Machine(std::unique_ptr<NesMapper> & cartridge)
-        : mapper(cartridge.release()),
-        ppumap(nullptr, mapper.get()),
-        ppu(&ppumap),
-        cpumap(nullptr, &apu, &ppu, mapper.get(), &ctrl),
-        cpu("6502", &cpumap) {
-        cpumap.CPU = &cpu;
-        apu.DMC1.Output.DMA.CPU = &cpu;
-        cpu.PowerUp();
-    }
-
-    void Reset() { cpu.Reset(); }
-
-    std::pair<bool, float> Step() {
-        const auto frame = ppu.FrameCount;
-        cpu.Tick();
-        ppu.Tick();
-        ppu.Tick();
-        ppu.Tick();
-        const auto cpuSample = apu.Tick();
-        const auto sample = mapper->Tick(cpuSample);
-        return{ ppu.FrameCount != frame, sample };
-    }
-
-    void StepOneCpuInstruction() {
-        do {
-            cpu.Tick();
-            ppu.Tick();
-            ppu.Tick();
-            ppu.Tick();
-            apu.Tick();
-        } while (cpu.CurrentTick < cpu.Ticks);
-    }
-};
-
-namespace replay {
-    enum Commands : char {
-        FrameStart = 0x0F,
-        Player_1 = 0x01,
-        CheckFrame = 0x81,
-        FrameEnd = 0x00,
-        Reset = 0x40,
-    };
-    Byte GetP1State(const Machine & nes) {
-        return Mask<0>(nes.ctrl.P1_A)
-             | Mask<1>(nes.ctrl.P1_B)
-             | Mask<2>(nes.ctrl.P1_Select)
-             | Mask<3>(nes.ctrl.P1_Start)
-             | Mask<4>(nes.ctrl.P1_Up)
-             | Mask<5>(nes.ctrl.P1_Down)
-             | Mask<6>(nes.ctrl.P1_Left)
-             | Mask<7>(nes.ctrl.P1_Right);
-    }
-    void SetP1State(Machine & nes, Byte p1) {
-        nes.ctrl.P1_A      = IsBitSet<0>(p1);
-        nes.ctrl.P1_B      = IsBitSet<1>(p1);
-        nes.ctrl.P1_Select = IsBitSet<2>(p1);
-        nes.ctrl.P1_Start  = IsBitSet<3>(p1);
-        nes.ctrl.P1_Up     = IsBitSet<4>(p1);
-        nes.ctrl.P1_Down   = IsBitSet<5>(p1);
-        nes.ctrl.P1_Left   = IsBitSet<6>(p1);
-        nes.ctrl.P1_Right  = IsBitSet<7>(p1);
-    }
-}
 namespace debug {
     std::string GetCPUInstruction(const Cpu & cpu) {
         static std::string names[] = {
@@ -333,6 +265,10 @@ void usage() {
     std::cout << "    nesfile    Path the the NES ROM file" << std::endl;
     std::cout << "Options:" << std::endl;
     std::cout << "    -help            Print this help message" << std::endl;
+    std::cout << "    -fast            Run whole CPU instructions away from I/O" << std::endl;
+    std::cout << "    -rewind MB       Hold F to rewind, keeping MB megabytes of history" << std::endl;
+    std::cout << "    -rewind-every N  Frames between rewind save states (default 4)" << std::endl;
+    std::cout << "    -runahead N      Show the frame N frames ahead of the input, F6/F7 change N" << std::endl;
 }
 
 void error(const std::string & message) {
@@ -351,95 +287,48 @@ enum class Options
     Record,
     Replay,
     Test,
+    Dumps,
     NSF,
+    Fast,
+    Rewind,
 };
 
 static int frames = 0;
-static std::vector<Sint16> SDLaudio;
-void PushFrameSamples(const std::vector<float> & frame) {
+// Two device buffers of latency at most, newer samples are dropped
+static SpscRing<Sint16, 8192> SDLaudio;
+void PushFrameSamples(BlipBuffer & audio) {
     frames++;
-    //const int step = 37; // 1.789773 MHz / 48 kHz ~= 37.29 APU samples per audio sample
-    // Single frame samples (1/60th of a second)
-    //std::cout << " " << SDLaudio.size();
-    //const float fstep = frame.size() / 800.0f;
-    //float step = fstep;
-    //int i = 0;
-    //float s = 0.0f;
-    //const int size = frame.size();
-    //while (i < size) {
-    //    s += frame[i];
-    //    ++i;
-    //    if (i > step) {
-    //        Sint16 SampleValue = 20000 * (s / fstep) - 10000;
-    //        SDLaudio.push_back(SampleValue);
-    //        s = 0.0f;
-    //        step += fstep;
-    //    }
-    //}
-    //std::cout << " " << SDLaudio.size() << std::endl;
-    //if ((size % step) != 0) {
-    //    Sint16 SampleValue = 20000 * (s / float(size % step)) - 10000;
-    //    SDLaudio.push_back(SampleValue);
-    //}
-
-    enum DownsamplingMethod {
-        DropSamples,
-        AverageSamples,
-    };
-
-    const DownsamplingMethod method = DropSamples;
-    switch (method)
-    {
-    case AverageSamples: {
-        const int size = frame.size();
-        const int step = 37; // 1.789773 MHz / 48 kHz ~= 37.29 APU samples per audio sample
-        for (size_t i = 0; i + step < size; i += step) {
-            float s = 0.0f;
-            for (size_t j = 0; j < step; j++)
-                s += frame[i + j];
-            Sint16 SampleValue = 20000 * (s / float(step)) - 10000;
-            SDLaudio.push_back(SampleValue);
-        }
-    } break;
-    case DropSamples:
-    default: {
-        const int step = 37; // 1.789773 MHz / 48 kHz ~= 37.29 APU samples per audio sample
-        for (size_t i = 0; i < 800; i++) {
-            const float s = frame[step * i];
-            Sint16 SampleValue = 20000 * s - 10000;
-            SDLaudio.push_back(SampleValue);
-        }
-    } break;
+    std::array<Sint16, 2048> chunk;
+    while (audio.SamplesAvailable() > 0) {
+        const auto count = audio.ReadSamples(chunk.data(), chunk.size());
+        SDLaudio.Push(chunk.data(), count);
     }
 }
 void FillAudioDeviceBuffer(void* UserData, Uint8* DeviceBuffer, int Length)
 {
-    std::fill_n(DeviceBuffer, Length, Uint8(0));
-
-    //if (frames < 2) return;
+    // Silence until a whole buffer is ready
+    Sint16* SampleBuffer = (Sint16*)DeviceBuffer;
     const int SamplesToWrite = Length / 2;
-    if (SDLaudio.size() < SamplesToWrite) {
-        return;
-    }
-    if (SDLaudio.size() > 2 * SamplesToWrite) {
-        SDLaudio.resize(2 * SamplesToWrite);
+    if (!SDLaudio.Pop(SampleBuffer, SamplesToWrite)) {
+        std::fill_n(DeviceBuffer, Length, Uint8(0));
     }
+}
 
-    Sint16* SampleBuffer = (Sint16*)DeviceBuffer;
-    for (int SampleIndex = 0;
-        SampleIndex < SamplesToWrite;
-        SampleIndex++)
-    {
-        Sint16 SampleValue = SDLaudio[SampleIndex];
-        *SampleBuffer++ = SampleValue;
-    }
-    for (int i = 0; i + SamplesToWrite < SDLaudio.size(); ++i) {
-        SDLaudio[i] = SDLaudio[i + SamplesToWrite];
+// Time spent in the parts of host frames, summed until printed
+struct FrameTimes {
+    Uint64 Record = 0;
+    Uint64 Emulate = 0;
+    Uint64 Save = 0;
+    Uint64 Ahead = 0;
+    Uint64 Load = 0;
+    Uint64 Frames = 0;
+
+    static Uint64 Now() { return SDL_GetPerformanceCounter(); }
+
+    double Micros(const Uint64 ticks) const {
+        return (Frames == 0) ? 0.0 : 1e6 * ticks / SDL_GetPerformanceFrequency() / Frames;
     }
-    //samples.resize(10000);
-    SDLaudio.resize(SDLaudio.size() - SamplesToWrite);
-    //samples.clear();
-}
+};
 
 struct Fps {
     int fps = -1;
@@ -458,94 +347,33 @@ struct Fps {
     }
 };
 
-int main(int argc, char ** argv) {
-    BuildPalette();
-
-    std::vector<std::string> positionals;
-    std::set<Options> options;
-    std::string recordFilename;
-    for (int i = 1; i < argc; ++i) {
-        std::string param(argv[i]);
-        if (param[0] == '-') {
-            if (param == "-help") {
-                usage();
-                return 0;
-            }
-            else if (param == "-debug") {
-                options.insert(Options::Debug);
-            }
-            else if (param == "-record") {
-                options.insert(Options::Record);
-                recordFilename = argv[++i];
-            }
-            else if (param == "-replay") {
-                options.insert(Options::Replay);
-                recordFilename = argv[++i];
-            }
-            else if (param == "-test") {
-                options.insert(Options::Test);
-                recordFilename = argv[++i];
-            }
-            else if (param == "-nsf") {
-                options.insert(Options::NSF);
-            }
-            else {
-                error("Unrecognized parameter: " + param);
-                return 1;
-            }
-        }
-        else {
-            positionals.push_back(param);
-        }
-    }
-
-    auto IsSet = [&options](const Options & opt) { return options.count(opt) == 1; };
+// Runs the front-end on the console built for the cartridge, instantiated
+// for every console type by WithConsole
+struct Session {
+    const std::set<Options> & options;
+    movie::Player * player;
+    movie::Writer * recorder;
+    size_t rewindBytes;
+    size_t rewindInterval;
+    int runAhead;
 
     Fps fps;
     bool showFps = false;
     int frameSkip = 0;
 
-    try {
-        std::string filepath;
-        
-        std::ifstream replay;
-        if (IsSet(Options::Replay) || IsSet(Options::Test)) {
-            replay.open(recordFilename);
-            std::getline(replay, filepath, '\0');
-        } else {
-            if (positionals.size() != 1) {
-                error("Please specify a NES ROM file");
-                return 1;
-            }
-            filepath = positionals[0];
-        }
-        std::ofstream record;
-        if (IsSet(Options::Record)) {
-            record.open(recordFilename);
-            record << filepath.c_str() << '\0';
-        }
+    Session(const std::set<Options> & options, movie::Player * player, movie::Writer * recorder,
+            size_t rewindBytes, size_t rewindInterval, int runAhead)
+        : options(options), player(player), recorder(recorder),
+          rewindBytes(rewindBytes), rewindInterval(rewindInterval), runAhead(runAhead)
+    {}
 
-        std::unique_ptr<NesMapper> mapper;
-        if (IsSet(Options::NSF)) {
-            log("Opening NSF ROM at " + filepath + " ...");
-            std::ifstream file(filepath, std::ios::binary);
-            NsfFile rom(file);
-            log("Done.");
-            mapper.reset(new Mapper_NSF(rom));
-        } else {
-            log("Opening NES ROM at " + filepath + " ...");
-            std::ifstream file(filepath, std::ios::binary);
-            NesFile rom(file);
-            log("Done.");
-            switch (rom.Header.MapperNumber) {
-            case 0: mapper.reset(new Mapper_000(rom)); break;
-            case 1: mapper.reset(new Mapper_001(rom)); break;
-            case 2: mapper.reset(new Mapper_002(rom)); break;
-            case 3: mapper.reset(new Mapper_003(rom)); break;
-            }
-        }
-        
-        Machine nes(mapper);
+    bool IsSet(const Options & opt) const { return options.count(opt) == 1; }
+
+    template <class Console_t>
+    void operator()(Console_t & nes) {
+        nes.cpu.FastPath = IsSet(Options::Fast);
+        // The debugger shows every dot, blanking included
+        nes.ppu.FullFrame = IsSet(Options::Debug);
 
         if (IsSet(Options::Debug)) {
             bool quit = false;
@@ -729,67 +557,39 @@ int main(int argc, char ** argv) {
                 if (step > 0) {
                     --step;
                     ++counter;
-                    nes.StepOneCpuInstruction();
+                    nes.RunInstruction();
+                    nes.Audio.Clear();
                 }
 
             }
         }
         else if (IsSet(Options::Test)) {
-            bool quit = false;
-            while (!quit) {
-                const auto pair = nes.Step();
-                if (pair.first) {
-                    char cmd;
-                    replay >> cmd;
-                    quit = replay.eof();
-
-                    bool finished = quit;
-                    while (!finished) {
-                        replay >> cmd;
-                        switch (cmd) {
-                        case replay::FrameEnd: {
-                            finished = true;
-                            break;
-                        }
-                        case replay::Player_1: {
-                            Byte p1;
-                            replay >> p1;
-                            replay::SetP1State(nes, p1);
-                            break;
-                        }
-                        case replay::CheckFrame: {
-                            std::cout << "Check frame" << std::endl;
-                            Byte d;
-                            bool success = true;
-                            std::array<Uint32, VIDEO_SIZE> difference;
-                            for (int i = 0; i < VIDEO_SIZE; ++i) {
-                                replay >> d;
-                                const bool isSame = (nes.ppu.Frame[i] == d);
-                                success = success && isSame;
-                                difference[i] = isSame ? Grey(32) : Grey(224);
-                            }
-                            if (!success) {
-                                SDL::SetScale(3);
-                                SDL::Show(VIDEO_WIDTH, VIDEO_HEIGHT, difference.data());
-                                throw std::runtime_error("Frame check failed");
-                            }
-                            break;
-                        }
-                        case replay::Reset: {
-                            nes.Reset();
-                            break;
-                        }
-                        }
+            auto check = [&nes](const movie::Checkpoint & checkpoint) {
+                std::cout << "Check frame" << std::endl;
+                if (checkpoint.Matches(nes.ppu.Screen)) return;
+                // The differences can only be shown with frame dumps
+                if (!checkpoint.Pixels.empty()) {
+                    const auto picture = movie::PictureOf(nes.ppu.Screen);
+                    std::array<Uint32, FRAME_WIDTH * FRAME_HEIGHT> difference;
+                    for (size_t i = 0; i < difference.size(); ++i) {
+                        difference[i] = (picture[i] == checkpoint.Pixels[i]) ? Grey(32) : Grey(224);
                     }
+                    SDL::SetScale(3);
+                    SDL::Show(FRAME_WIDTH, FRAME_HEIGHT, difference.data());
                 }
-            }
+                throw std::runtime_error("Frame check failed");
+            };
+            do {
+                nes.RunUntilFrame();
+                nes.Audio.Clear();
+            } while (player->PlayFrame(nes, check));
         }
         else {
             bool replayCheckFrame = false;
             bool replayReset = false;
             SDL::SetScale(3);
 
-            std::array<Uint32, VIDEO_SIZE> pixels;
+            std::array<Uint32, FRAME_WIDTH * FRAME_HEIGHT> pixels;
             pixels.fill(0);
 
             SDL_Window * win;
@@ -797,15 +597,15 @@ int main(int argc, char ** argv) {
             SDL_Texture * tex;
             win = SDL_CreateWindow("Software Renderer",
                 SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-                SDL::get()->Scale * VIDEO_WIDTH, SDL::get()->Scale * VIDEO_HEIGHT,
+                SDL::get()->Scale * FRAME_WIDTH, SDL::get()->Scale * FRAME_HEIGHT,
                 SDL_WINDOW_SHOWN);
             ren = SDL_CreateRenderer(win, -1, SDL_RENDERER_PRESENTVSYNC);
             SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "nearest");
-            SDL_RenderSetLogicalSize(ren, VIDEO_WIDTH, VIDEO_HEIGHT);
+            SDL_RenderSetLogicalSize(ren, FRAME_WIDTH, FRAME_HEIGHT);
             tex = SDL_CreateTexture(ren,
                 SDL_PIXELFORMAT_RGBA8888,
                 SDL_TEXTUREACCESS_STREAMING,
-                VIDEO_WIDTH, VIDEO_HEIGHT);
+                FRAME_WIDTH, FRAME_HEIGHT);
 
             SDL_AudioSpec RequestedSettings = {};
             RequestedSettings.freq = 48000; // Our sampling rate
@@ -822,25 +622,57 @@ int main(int argc, char ** argv) {
             // Start music playing
             SDL_PauseAudioDevice(DeviceID, 0);
 
-            bool quit = false;
-            std::vector<float> samples;
-            while (!quit) {
-                const auto pair = nes.Step();
-                samples.push_back(pair.second);
-
-                if (pair.first) {
-                    PushFrameSamples(samples);
-                    samples.clear();
+            // Movies need every frame, rewinding would break them
+            std::unique_ptr<Rewind> rewind;
+            if (IsSet(Options::Rewind) && !IsSet(Options::Record) && !IsSet(Options::Replay)) {
+                rewind.reset(new Rewind(rewindBytes, rewindInterval));
+            }
+            bool rewinding = false;
+
+            // Run-ahead shows the frame runAhead frames later with the
+            // current input, then goes back to the state saved here
+            std::vector<Byte> aheadState;
+            FrameTimes times;
+
+            // The console runs on its own thread, paced by the host clock,
+            // and hands its screens over through frames; this thread owns
+            // the window, forwards the key events and converts and uploads
+            // the latest screen at the display rate
+            FrameExchange<IndexedFrame> frames;
+            SpscRing<SDL_Event, 64> events;
+            std::atomic<bool> quit(false);
+
+            auto emulate = [&]() {
+                const Uint64 period = SDL_GetPerformanceFrequency() * Console_t::CYCLES_PER_FRAME / Console_t::CPU_CLOCK_RATE;
+                Uint64 next = FrameTimes::Now();
+                while (!quit) {
+                    auto start = FrameTimes::Now();
+                    if (rewinding && rewind) {
+                        // Keep the buttons held now for when rewinding stops
+                        const Byte live = replay::GetP1State(nes.ctrl);
+                        nes.MuteAudio(true);
+                        rewind->StepBack(nes);
+                        nes.MuteAudio(false);
+                        replay::SetP1State(nes.ctrl, live);
+                    }
+                    else {
+                        if (rewind) {
+                            rewind->Record(nes);
+                            const auto recorded = FrameTimes::Now();
+                            times.Record += recorded - start;
+                            start = recorded;
+                        }
+                        nes.RunUntilFrame();
+                        PushFrameSamples(nes.Audio);
+                    }
+                    times.Emulate += FrameTimes::Now() - start;
                     SDL_Event e;
-                    while (SDL_PollEvent(&e) > 0)
+                    while (events.Available() > 0)
                     {
+                        events.Pop(&e, 1);
                         switch (e.type)
                         {
-                        case SDL_QUIT:
-                            quit = true;
-                            break;
                         case SDL_KEYDOWN: {
-                            quit = quit || (e.key.keysym.sym == SDLK_ESCAPE);
                             if (e.key.keysym.sym == SDLK_UP) nes.ctrl.P1_Up = true;
                             if (e.key.keysym.sym == SDLK_DOWN) nes.ctrl.P1_Down = true;
                             if (e.key.keysym.sym == SDLK_LEFT) nes.ctrl.P1_Left = true;
@@ -854,15 +686,17 @@ int main(int argc, char ** argv) {
                             if (e.key.keysym.sym == SDLK_F3) nes.apu.Triangle1Output = 1 - nes.apu.Triangle1Output;
                             if (e.key.keysym.sym == SDLK_F4) nes.apu.Noise1Output = 1 - nes.apu.Noise1Output;
                             if (e.key.keysym.sym == SDLK_F5) nes.apu.DMC1Output = 1 - nes.apu.DMC1Output;
+                            if (e.key.keysym.sym == SDLK_F6) runAhead = std::max(0, runAhead - 1);
+                            if (e.key.keysym.sym == SDLK_F7) runAhead = std::min(8, runAhead + 1);
                             if (e.key.keysym.sym == SDLK_F10) --frameSkip;
                             if (e.key.keysym.sym == SDLK_F11) ++frameSkip;
                             if (e.key.keysym.sym == SDLK_F12) showFps = !showFps;
                             if (e.key.keysym.sym == SDLK_SPACE) replayCheckFrame = true;
                             if (e.key.keysym.sym == SDLK_BACKSPACE) replayReset = true;
+                            if (e.key.keysym.sym == SDLK_f) rewinding = true;
                             break;
                         }
                         case SDL_KEYUP: {
-                            quit = quit || (e.key.keysym.sym == SDLK_ESCAPE);
                             if (e.key.keysym.sym == SDLK_UP) nes.ctrl.P1_Up = false;
                             if (e.key.keysym.sym == SDLK_DOWN) nes.ctrl.P1_Down = false;
                             if (e.key.keysym.sym == SDLK_LEFT) nes.ctrl.P1_Left = false;
@@ -871,52 +705,18 @@ int main(int argc, char ** argv) {
                             if (e.key.keysym.sym == SDLK_p) nes.ctrl.P1_Start = false;
                             if (e.key.keysym.sym == SDLK_s) nes.ctrl.P1_A = false;
                             if (e.key.keysym.sym == SDLK_q) nes.ctrl.P1_B = false;
+                            if (e.key.keysym.sym == SDLK_f) rewinding = false;
                             break;
                         }
                         }
                     }
                     if (IsSet(Options::Record)) {
-                        record << char{ replay::FrameStart }
-                            << char{ replay::Player_1 }
-                            << replay::GetP1State(nes);
-                        if (replayCheckFrame) {
-                            record << char{ replay::CheckFrame };
-                            for (int i = 0; i < VIDEO_SIZE; ++i) record << nes.ppu.Frame[i];
-                            replayCheckFrame = false;
-                        }
-                        if (replayReset) record << char{ replay::Reset };
-                        record << char{ replay::FrameEnd };
-                    }
-                    if (IsSet(Options::Replay)) {
-                        char cmd;
-                        Byte p1;
-                        replay >> cmd;
-                        SDL_assert(cmd == replay::FrameStart);
-                        bool finished = false;
-                        do {
-                            replay >> cmd;
-                            switch (cmd) {
-                            case replay::FrameEnd: {
-                                finished = true;
-                                break;
-                            }
-                            case replay::Player_1: {
-                                replay >> p1;
-                                replay::SetP1State(nes, p1);
-                                break;
-                            }
-                            case replay::CheckFrame: {
-                                Byte d;
-                                for (int i = 0; i < VIDEO_SIZE; ++i) replay >> d;
-                                break;
-                            }
-                            case replay::Reset: {
-                                nes.Reset();
-                                break;
-                            }
-                            }
-                        } while (!finished);
+                        movie::Checkpoint checkpoint;
+                        if (replayCheckFrame) checkpoint = movie::CheckpointOf(movie::PictureOf(nes.ppu.Screen));
+                        recorder->EndFrame(replay::GetP1State(nes.ctrl), replayCheckFrame ? &checkpoint : nullptr, replayReset);
+                        replayCheckFrame = false;
                     }
+                    if (IsSet(Options::Replay)) player->PlayFrame(nes);
                     if (replayReset) {
                         nes.Reset();
                         replayReset = false;
@@ -924,41 +724,213 @@ int main(int argc, char ** argv) {
 
                     const auto ticks = SDL_GetTicks();
                     if (fps.update(ticks)) {
-                        if (showFps) std::cout << fps.fps << std::endl;
-                    }
-
-                    if (frameSkip <= 0) {
-                        for (auto i = 0; i < VIDEO_SIZE; ++i) {
-                            pixels[i] = palette[nes.ppu.Frame[i]];
+                        if (showFps) std::cout << fps.fps
+                            << " audio underruns " << SDLaudio.Underruns
+                            << " overruns " << SDLaudio.Overruns
+                            << " screens dropped " << frames.Dropped << std::endl;
+                        if (showFps) std::cout << "host frame us: emulate " << times.Micros(times.Emulate)
+                            << " run-ahead " << runAhead << " save " << times.Micros(times.Save)
+                            << " ahead " << times.Micros(times.Ahead) << " load " << times.Micros(times.Load) << std::endl;
+                        if (showFps && rewind) {
+                            std::cout << "rewind " << (rewind->Frames() - rewind->OldestFrame() + 1) / 60 << "s"
+                                << " in " << rewind->BytesUsed() / 1024 << "/" << rewind->Capacity / 1024 << " KiB"
+                                << ", last state " << rewind->LastDeltaSize << " bytes"
+                                << ", " << times.Micros(times.Record) << " us per frame" << std::endl;
                         }
+                        times = FrameTimes();
+                    }
 
-                        auto skip = frameSkip;
-                        while (skip <= 0) {
-                            SDL_UpdateTexture(tex, NULL, pixels.data(), VIDEO_WIDTH * sizeof(Uint32));
-                            SDL_RenderCopy(ren, tex, NULL, NULL);
-                            SDL_RenderPresent(ren);
-                            SDL_UpdateWindowSurface(win);
-                            ++skip;
-                        }
+                    const bool ahead = (runAhead > 0) && !(rewinding && rewind);
+                    if (ahead) {
+                        const auto saving = FrameTimes::Now();
+                        nes.SaveState(aheadState);
+                        const auto running = FrameTimes::Now();
+                        nes.MuteAudio(true);
+                        for (int i = 0; i < runAhead; ++i) nes.RunUntilFrame();
+                        nes.MuteAudio(false);
+                        times.Save += running - saving;
+                        times.Ahead += FrameTimes::Now() - running;
                     }
-                    else {
-                        for (auto i = 0; i < VIDEO_SIZE; ++i) {
-                            pixels[i] = palette[nes.ppu.Frame[i]];
-                        }
+                    // The PPU draws the next frames into the back screen
+                    std::swap(nes.ppu.Screen, frames.Back());
+                    frames.Publish();
+                    if (ahead) {
+                        // The next frame overwrites the whole picture of the
+                        // frames run ahead
+                        const auto loading = FrameTimes::Now();
+                        nes.LoadState(aheadState);
+                        times.Load += FrameTimes::Now() - loading;
+                    }
+
+                    // Below frame skip 0 every frame lasts 1 - frameSkip
+                    // periods, after a stall the pace starts over
+                    next += period * ((frameSkip < 0) ? 1 - frameSkip : 1);
+                    const auto now = FrameTimes::Now();
+                    if (now < next) SDL_Delay(Uint32(1000 * (next - now) / SDL_GetPerformanceFrequency()));
+                    else if (now - next > 4 * period) next = now;
+                    ++times.Frames;
+                }
+            };
+
+            std::exception_ptr failure;
+            std::thread emulation([&]() {
+                try {
+                    emulate();
+                }
+                catch (...) {
+                    failure = std::current_exception();
+                    quit = true;
+                }
+            });
 
-                        SDL_UpdateTexture(tex, NULL, pixels.data(), VIDEO_WIDTH * sizeof(Uint32));
-                        SDL_RenderCopy(ren, tex, NULL, NULL);
-                        SDL_RenderPresent(ren);
-                        SDL_UpdateWindowSurface(win);
+            std::array<Word, FRAME_WIDTH> line;
+            while (!quit) {
+                SDL_Event e;
+                while (SDL_PollEvent(&e) > 0)
+                {
+                    if (e.type == SDL_QUIT) quit = true;
+                    if ((e.type == SDL_KEYDOWN) || (e.type == SDL_KEYUP)) {
+                        if (e.key.keysym.sym == SDLK_ESCAPE) quit = true;
+                        events.Push(&e, 1);
                     }
                 }
+                if (!frames.Take()) {
+                    SDL_Delay(1);
+                    continue;
+                }
+                const auto & screen = frames.Front();
+                for (size_t y = 0; y < FRAME_HEIGHT; ++y) {
+                    screen.Line(y, line.data());
+                    for (size_t x = 0; x < FRAME_WIDTH; ++x) pixels[FRAME_WIDTH * y + x] = palette[line[x]];
+                }
+                SDL_UpdateTexture(tex, NULL, pixels.data(), FRAME_WIDTH * sizeof(Uint32));
+                SDL_RenderCopy(ren, tex, NULL, NULL);
+                SDL_RenderPresent(ren);
+                SDL_UpdateWindowSurface(win);
             }
+            emulation.join();
 
             SDL_CloseAudioDevice(DeviceID);
 
             SDL_DestroyTexture(tex);
             SDL_DestroyRenderer(ren);
             SDL_DestroyWindow(win);
+            if (failure) std::rethrow_exception(failure);
+        }
+    }
+};
+
+int main(int argc, char ** argv) {
+    BuildPalette();
+
+    std::vector<std::string> positionals;
+    std::set<Options> options;
+    std::string recordFilename;
+    size_t rewindBytes = 0;
+    size_t rewindInterval = 4;
+    int runAhead = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string param(argv[i]);
+        if (param[0] == '-') {
+            if (param == "-help") {
+                usage();
+                return 0;
+            }
+            else if (param == "-debug") {
+                options.insert(Options::Debug);
+            }
+            else if (param == "-record") {
+                options.insert(Options::Record);
+                recordFilename = argv[++i];
+            }
+            else if (param == "-replay") {
+                options.insert(Options::Replay);
+                recordFilename = argv[++i];
+            }
+            else if (param == "-test") {
+                options.insert(Options::Test);
+                recordFilename = argv[++i];
+            }
+            else if (param == "-dumps") {
+                options.insert(Options::Dumps);
+            }
+            else if (param == "-nsf") {
+                options.insert(Options::NSF);
+            }
+            else if (param == "-fast") {
+                options.insert(Options::Fast);
+            }
+            else if (param == "-rewind" && i + 1 < argc) {
+                options.insert(Options::Rewind);
+                rewindBytes = std::stoul(argv[++i]) << 20;
+            }
+            else if (param == "-rewind-every" && i + 1 < argc) {
+                rewindInterval = std::stoul(argv[++i]);
+            }
+            else if (param == "-runahead" && i + 1 < argc) {
+                runAhead = std::max(0, std::stoi(argv[++i]));
+            }
+            else {
+                error("Unrecognized parameter: " + param);
+                return 1;
+            }
+        }
+        else {
+            positionals.push_back(param);
+        }
+    }
+
+    auto IsSet = [&options](const Options & opt) { return options.count(opt) == 1; };
+
+    try {
+        std::string filepath;
+        
+        std::ifstream replayFile;
+        std::unique_ptr<movie::Player> player;
+        if (IsSet(Options::Replay) || IsSet(Options::Test)) {
+            replayFile.open(recordFilename, std::ios::binary);
+            player.reset(new movie::Player(replayFile));
+            filepath = player->MovieHeader.RomPath;
+        } else {
+            if (positionals.size() != 1) {
+                error("Please specify a NES ROM file");
+                return 1;
+            }
+            filepath = positionals[0];
+        }
+        log("Opening ROM at " + filepath + " ...");
+        std::ifstream file(filepath, std::ios::binary);
+        std::stringstream content;
+        content << file.rdbuf();
+        log("Done.");
+
+        movie::Header header;
+        header.Flags = IsSet(Options::Dumps) ? movie::FrameDumps : 0;
+        header.RomSha1 = Sha1::Of(content.str());
+        header.RomPath = filepath;
+        if (player && !player->IsLegacy && player->MovieHeader.RomSha1 != header.RomSha1) {
+            log("Warning: the movie was recorded with another ROM");
+        }
+
+        std::ofstream recordFile;
+        std::unique_ptr<movie::Writer> recorder;
+        if (IsSet(Options::NSF)) {
+            NsfFile rom(content);
+            if (IsSet(Options::Record)) {
+                recordFile.open(recordFilename, std::ios::binary);
+                recorder.reset(new movie::Writer(recordFile, header));
+            }
+            Session session(options, player.get(), recorder.get(), rewindBytes, rewindInterval, runAhead);
+            WithConsole(rom, session);
+        } else {
+            NesFile rom(content);
+            header.Mapper = rom.Header.MapperNumber;
+            if (IsSet(Options::Record)) {
+                recordFile.open(recordFilename, std::ios::binary);
+                recorder.reset(new movie::Writer(recordFile, header));
+            }
+            Session session(options, player.get(), recorder.get(), rewindBytes, rewindInterval, runAhead);
+            WithConsole(rom, session);
         }
     }
     catch (const std::exception & e) {
@@ -3,6 +3,13 @@
 
 #include "Types.h"
 #include "BitUtil.h"
+#include "Mapper.h"
+#include "BlipBuffer.h"
+#include "State.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
 //#include "Palette.h"
 //#include "MemoryMap.h"
 //
@@ -16,6 +23,13 @@
 //static constexpr size_t VIDEO_HEIGHT = 262;
 //static constexpr size_t VIDEO_SIZE = VIDEO_WIDTH * VIDEO_HEIGHT;
 
+// Catch-up helpers
+// Steady() is the number of upcoming Tick() calls without a frame clock
+// that return the same output as the next one, Skip(count) does the same as
+// that many calls
+
+static constexpr size_t STEADY_FOREVER = std::numeric_limits<size_t>::max();
+
 ////////////////////////////////////////////////////////////////////////////////
 // Clock divider
 
@@ -54,6 +68,11 @@ struct FrameCounter {
     bool HideInterrupt = false;
     bool Interrupt = false;
 
+    template <class State_t>
+    void Serialize(State_t & state) {
+        state(Ticks, Mode, HideInterrupt, Interrupt);
+    }
+
     Clock Tick() {
         static constexpr int SetInterruptTick = 29828;
         static constexpr int ResetInterruptTick = 1;
@@ -90,6 +109,23 @@ struct FrameCounter {
         return result;
     }
 
+    size_t Steady() const {
+        static constexpr int Events[7] = { 1, 7457, 14913, 22371, 29828, 29829, 37281 };
+        static constexpr int Periods[2] = { 29830, 37282 };
+        const int period = Periods[Mode];
+        if (Ticks >= period) return 0;
+        if (Interrupt && (Mode == 1 || HideInterrupt)) return 0;
+        for (const auto e : Events) {
+            if (e >= Ticks && e < period) return e - Ticks;
+        }
+        return period - Ticks + 1;
+    }
+
+    void Skip(const size_t count) {
+        static constexpr int Periods[2] = { 29830, 37282 };
+        Ticks = int((Ticks + count) % Periods[Mode]);
+    }
+
     void WriteControl(const Byte value) {
         Mode = Bit<7>(value);
         HideInterrupt = IsBitSet<6>(value);
@@ -103,6 +139,11 @@ struct EnvelopeGenerator {
     int Value = 0;
     int Divider = 1;
     int Volume = 0;
+
+    template <class State_t>
+    void Serialize(State_t & state) {
+        state(Restart, Loop, Enabled, Value, Divider, Volume);
+    }
     
     Byte Tick(const bool quarterFrame) {
         if (quarterFrame) {
@@ -127,6 +168,11 @@ struct LengthCounter {
     int Count = 0x0A;   // Lengths[0]
     bool Halt = false;
 
+    template <class State_t>
+    void Serialize(State_t & state) {
+        state(Count, Halt);
+    }
+
     void SetCountIndex(const int value) {
         static constexpr Byte Lengths[0x20] = {
             0x0A, 0xFE, 0x14, 0x02, 0x28, 0x04, 0x50, 0x06,
@@ -152,14 +198,23 @@ struct Sequencer {
     int Duty = 0;
     int Phase = 0;
 
-    Byte Tick(const bool timer) {
+    template <class State_t>
+    void Serialize(State_t & state) {
+        state(Duty, Phase);
+    }
+
+    Byte Value() const {
         static constexpr Byte Sequences[4][8] = {
             { 0, 1, 0, 0, 0, 0, 0, 0 },
             { 0, 1, 1, 0, 0, 0, 0, 0 },
             { 0, 1, 1, 1, 1, 0, 0, 0 },
             { 1, 0, 0, 1, 1, 1, 1, 1 }
         };
-        const auto value = Sequences[Duty][Phase];
+        return Sequences[Duty][Phase];
+    }
+
+    Byte Tick(const bool timer) {
+        const auto value = Value();
         if (timer) Phase = (Phase + 1) % 8;
         return value;
     }
@@ -168,14 +223,23 @@ struct Sequencer {
 struct TriangleSequencer {
     int Phase = 0;
 
-    Byte Tick(const bool timer) {
+    template <class State_t>
+    void Serialize(State_t & state) {
+        state(Phase);
+    }
+
+    Byte Value() const {
         static constexpr Byte Sequence[32] = {
             0xF, 0xE, 0xD, 0xC, 0xB, 0xA, 0x9, 0x8,
             0x7, 0x6, 0x5, 0x4, 0x3, 0x2, 0x1, 0x0,
             0x0, 0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7,
             0x8, 0x9, 0xA, 0xB, 0xC, 0xD, 0xE, 0xF
         };
-        const auto value = Sequence[Phase];
+        return Sequence[Phase];
+    }
+
+    Byte Tick(const bool timer) {
+        const auto value = Value();
         if (timer)
             Phase = (Phase + 1) % 32;
         return value;
@@ -188,6 +252,11 @@ struct LinearCounter {
     bool Reload = false;
     bool Control = false;
 
+    template <class State_t>
+    void Serialize(State_t & state) {
+        state(Count, ReloadValue, Reload, Control);
+    }
+
     int Tick(const bool quarterFrame) {
         const int value = ((Count > 0) ? 1 : 0);
         if (quarterFrame) {
@@ -205,16 +274,33 @@ struct LinearCounter {
 
 struct FlipFlop {
     bool State = false;
+
+    template <class State_t>
+    void Serialize(State_t & state) {
+        state(State);
+    }
     operator bool() {
         State = !State;
         return State;
     }
+
+    // Number of the next count toggles that turn it on
+    size_t Advance(const size_t count) {
+        const size_t on = State ? (count / 2) : ((count + 1) / 2);
+        if (count % 2 == 1) State = !State;
+        return on;
+    }
 };
 
 struct Timer {
     Word Period = 1;
     Word T = 0;
 
+    template <class State_t>
+    void Serialize(State_t & state) {
+        state(Period, T);
+    }
+
     bool Tick() {
         if (T == 0) {
             T = Period - 1;
@@ -224,6 +310,19 @@ struct Timer {
         return false;
     }
 
+    // Number of the next count ticks that fire
+    size_t Advance(size_t count) {
+        if (count <= T) {
+            T = Word(T - count);
+            return 0;
+        }
+        count -= size_t(T) + 1;
+        const Word reload = Period - 1;
+        const size_t length = size_t(reload) + 1;
+        T = Word(reload - count % length);
+        return 1 + count / length;
+    }
+
     void SetPeriodLow(const Byte lo) {
         auto t = Period - 1;
         t = (t & WORD_HI_MASK) | lo;
@@ -297,20 +396,21 @@ struct Pulse {
         SweepReload = true;
     }
 
-    Byte TickSweep(const bool halfFrame) {
+    int TargetPeriod() const {
         const auto period = T.Period;
-        auto result = 1;
         if (SweepNegate) {
-            SweepTargetPeriod = period - (period >> SweepAmount);
-            if (SweepAlternativeNegate) {
-                SweepTargetPeriod -= 1;
-            }
+            return period - (period >> SweepAmount) - (SweepAlternativeNegate ? 1 : 0);
         }
-        else {
-            SweepTargetPeriod = period + (period >> SweepAmount);
-        }
-        if (SweepTargetPeriod >= 0x0800) result = 0;
-        if (period < 9) result = 0;
+        return period + (period >> SweepAmount);
+    }
+
+    Byte SweepOutput(const int target) const {
+        return ((target >= 0x0800) || (T.Period < 9)) ? 0 : 1;
+    }
+
+    Byte TickSweep(const bool halfFrame) {
+        SweepTargetPeriod = TargetPeriod();
+        const auto result = SweepOutput(SweepTargetPeriod);
 
         if (halfFrame) {
             if ((SweepT == 0) && SweepEnabled && (result == 1) && (SweepAmount > 0)) {
@@ -338,6 +438,43 @@ struct Pulse {
         const auto length = Length.Tick(clock.HalfFrame);
         return volume * sequence * length * sweep;
     }
+
+    // Volume, length and sweep gates, constant without frame clocks
+    Byte Gate() const {
+        const Byte volume = Envelope.Enabled ? Envelope.Value : Envelope.Volume;
+        const Byte length = (Length.Count == 0) ? 0 : 1;
+        return volume * length * SweepOutput(TargetPeriod());
+    }
+
+    Byte Output() const {
+        return Enabled ? Gate() * Sequence.Value() : 0;
+    }
+
+    size_t Steady() const {
+        if (!Enabled || Gate() == 0) return STEADY_FOREVER;
+        // The timer is clocked every other tick, the new phase is heard on
+        // the tick after it fires
+        const size_t clocks = size_t(T.T) + 1;
+        return flipflop.State ? (2 * clocks) : (2 * clocks - 1);
+    }
+
+    void Skip(const size_t count) {
+        if (!Enabled || count == 0) return;
+        const auto fires = T.Advance(flipflop.Advance(count));
+        Sequence.Phase = int((Sequence.Phase + fires) % 8);
+        SweepTargetPeriod = TargetPeriod();
+    }
+
+    template <class State_t>
+    void Serialize(State_t & state) {
+        Envelope.Serialize(state);
+        Length.Serialize(state);
+        Sequence.Serialize(state);
+        T.Serialize(state);
+        flipflop.Serialize(state);
+        state(Enabled, SweepEnabled, SweepPeriod, SweepT, SweepNegate, SweepAlternativeNegate,
+            SweepAmount, SweepTargetPeriod, SweepReload);
+    }
 };
 
 struct Triangle {
@@ -381,11 +518,45 @@ struct Triangle {
         const auto volume = Sequence.Tick(valid && !mute);
         return volume;
     }
+
+    bool Running() const {
+        return Enabled && (T.Period > 2) && (Counter.Count > 0) && (Length.Count != 0);
+    }
+
+    Byte Output() const {
+        return Sequence.Value();
+    }
+
+    size_t Steady() const {
+        if (!Running()) return STEADY_FOREVER;
+        return size_t(T.T) + 1;
+    }
+
+    void Skip(const size_t count) {
+        if (!Enabled) return;
+        const bool running = Running();
+        const auto fires = T.Advance(count);
+        if (running) Sequence.Phase = int((Sequence.Phase + fires) % 32);
+    }
+
+    template <class State_t>
+    void Serialize(State_t & state) {
+        state(Enabled);
+        Sequence.Serialize(state);
+        Length.Serialize(state);
+        Counter.Serialize(state);
+        T.Serialize(state);
+    }
 };
 
 struct ShiftRegister {
     bool Mode = false;
     int Value = 1;
+
+    template <class State_t>
+    void Serialize(State_t & state) {
+        state(Mode, Value);
+    }
     Byte Tick(bool timer) {
         const Byte bit0 = Bit<0>(Value);
         const Byte bitN = (Mode ? Bit<6>(Value) : Bit<1>(Value));
@@ -440,6 +611,36 @@ struct Noise {
         const auto length = Length.Tick(clock.HalfFrame);
         return volume * length * (1 - shifter);
     }
+
+    Byte Gate() const {
+        const Byte volume = Envelope.Enabled ? Envelope.Value : Envelope.Volume;
+        return (Length.Count == 0) ? 0 : volume;
+    }
+
+    Byte Output() const {
+        return Enabled ? Gate() * (1 - Bit<0>(Shifter.Value)) : 0;
+    }
+
+    // The shift register moves on every tick so only silence is steady
+    size_t Steady() const {
+        return (!Enabled || Gate() == 0) ? STEADY_FOREVER : 0;
+    }
+
+    void Skip(const size_t count) {
+        if (!Enabled) return;
+        T.Advance(flipflop.Advance(count));
+        for (size_t i = 0; i < count; ++i) Shifter.Tick(false);
+    }
+
+    template <class State_t>
+    void Serialize(State_t & state) {
+        state(Enabled);
+        T.Serialize(state);
+        Envelope.Serialize(state);
+        Length.Serialize(state);
+        flipflop.Serialize(state);
+        Shifter.Serialize(state);
+    }
 };
 
 struct SampleBuffer {
@@ -454,7 +655,7 @@ struct DMAReader {
     Word SampleAddress = 0xC000;
     Word SampleLength = 1;
 
-    Word Address;
+    Word Address = 0xC000;
     Word Length = 0;
 
     bool LoopSample = false;
@@ -462,6 +663,12 @@ struct DMAReader {
 
     bool Interrupt = false;
 
+    // CPU is wiring, not state
+    template <class State_t>
+    void Serialize(State_t & state) {
+        state(SampleAddress, SampleLength, Address, Length, LoopSample, InterruptEnabled, Interrupt);
+    }
+
     SampleBuffer GetSample() {
         if (Length == 0) return{ true, 0 }; 
         
@@ -498,7 +705,14 @@ struct DMCOutput {
 
     int BitsRemaining = 0;
     bool Silent = true;
-    Byte Sample;
+    Byte Sample = 0;
+
+    template <class State_t>
+    void Serialize(State_t & state) {
+        state(Value);
+        DMA.Serialize(state);
+        state(BitsRemaining, Silent, Sample);
+    }
 
     void Start() {
         BitsRemaining = 8;
@@ -525,6 +739,27 @@ struct DMCOutput {
         
         return Value;
     }
+
+    bool Idle() const {
+        return Silent && (DMA.Length == 0);
+    }
+
+    // Timer ticks until the sample buffer is refilled from memory
+    size_t FiresToRefill() const {
+        return size_t(std::max(BitsRemaining, 1));
+    }
+
+    // Same as fires silent Tick(true) with nothing to fetch
+    void SkipIdle(size_t fires) {
+        const auto refill = FiresToRefill();
+        if (fires < refill) {
+            BitsRemaining -= int(fires);
+            return;
+        }
+        fires -= refill;
+        BitsRemaining = 8 - int(fires % 8);
+        Sample = 0;
+    }
 };
 
 template <class Cpu_t>
@@ -534,6 +769,12 @@ struct DMC {
     DMCOutput<Cpu_t> Output;
     Timer T;
 
+    template <class State_t>
+    void Serialize(State_t & state) {
+        Output.Serialize(state);
+        T.Serialize(state);
+    }
+
     void WriteDAC(const Byte value) {
         Output.Value = value & 0x7F;
     }
@@ -565,6 +806,23 @@ struct DMC {
         const auto output = Output.Tick(timer);
         return output;
     }
+
+    size_t Steady() const {
+        return Output.Idle() ? STEADY_FOREVER : T.T;
+    }
+
+    void Skip(const size_t count) {
+        const auto fires = T.Advance(count);
+        if (fires > 0) Output.SkipIdle(fires);
+    }
+
+    // Ticks until the next sample fetch, which steals CPU cycles and can
+    // raise the interrupt
+    size_t CyclesToFetch() const {
+        if (Output.DMA.Length == 0) return STEADY_FOREVER;
+        const size_t length = size_t(Word(T.Period - 1)) + 1;
+        return size_t(T.T) + 1 + (Output.FiresToRefill() - 1) * length;
+    }
 };
 
 template <class Cpu_t>
@@ -658,18 +916,82 @@ public:
 
         const auto square1 = Pulse1Output * Pulse1.Tick(clock);
         const auto square2 = Pulse2Output * Pulse2.Tick(clock);
-
-        const auto squareOut = 95.88f / (100.0f + 8128.0f / (square1 + square2));
-
         const auto triangle = Triangle1Output * Triangle1.Tick(clock);
         const auto noise = Noise1Output * Noise1.Tick(clock);
         const auto dmc = DMC1Output * DMC1.Tick(clock);
 
-        const auto tndOut = 159.79f / (100.0f + 1.0f / (triangle / 8227.0f + noise / 12241.0f + dmc / 22638.0f));
+        return Mix(square1, square2, triangle, noise, dmc);
+    }
 
+    static float Mix(const int square1, const int square2, const int triangle, const int noise, const int dmc) {
+        const auto squareOut = 95.88f / (100.0f + 8128.0f / (square1 + square2));
+        const auto tndOut = 159.79f / (100.0f + 1.0f / (triangle / 8227.0f + noise / 12241.0f + dmc / 22638.0f));
         return squareOut + tndOut;
     }
 
+    // Catch-up scheduling
+    // CPU cycles are owed until something can observe them: a register
+    // access (Sync), a frame counter step or a DMC fetch which may raise an
+    // interrupt or steal cycles from the CPU. Catching up runs channels in
+    // bulk over the stretches where their output cannot change.
+    size_t PendingCycles = 0;
+    size_t DeadlineCycles = 0;
+
+    // One sample per CPU cycle is appended when set
+    std::vector<float> * Samples = nullptr;
+    // Output changes are added with their cycle in the audio frame when set
+    BlipBuffer * Blip = nullptr;
+    size_t BlipTime = 0;
+    // Cartridge sound mixed into every sample when set
+    NesMapper * Expansion = nullptr;
+
+    void Schedule(const size_t cycles) {
+        PendingCycles += cycles;
+        if (PendingCycles >= DeadlineCycles) CatchUp();
+    }
+
+    void CatchUp() {
+        while (PendingCycles > 0) {
+            const auto steady = std::min({ PendingCycles, Frame.Steady(),
+                Pulse1.Steady(), Pulse2.Steady(), Triangle1.Steady(),
+                Noise1.Steady(), DMC1.Steady() });
+            if (steady == 0) {
+                Emit(Tick(), 1);
+                --PendingCycles;
+                continue;
+            }
+            Emit(Mix(Pulse1Output * Pulse1.Output(), Pulse2Output * Pulse2.Output(),
+                Triangle1Output * Triangle1.Output(), Noise1Output * Noise1.Output(),
+                DMC1Output * DMC1.Output.Value), steady);
+            Frame.Skip(steady);
+            Pulse1.Skip(steady);
+            Pulse2.Skip(steady);
+            Triangle1.Skip(steady);
+            Noise1.Skip(steady);
+            DMC1.Skip(steady);
+            PendingCycles -= steady;
+        }
+        DeadlineCycles = CyclesToNextEvent();
+    }
+
+    // The access may change the next events so they are predicted again
+    // after the next cycle
+    void Sync() {
+        CatchUp();
+        DeadlineCycles = 0;
+    }
+
+    // Ends the audio frame at the last cycle caught up
+    void FlushAudio() {
+        if (Blip != nullptr) Blip->EndFrame(BlipTime);
+        BlipTime = 0;
+    }
+
+    size_t CyclesToNextEvent() const {
+        const auto frame = Frame.Steady();
+        return std::min(frame + 1, DMC1.CyclesToFetch());
+    }
+
     FrameCounter Frame;
 
     int Pulse1Output = 1;
@@ -686,6 +1008,43 @@ public:
 
     int DMC1Output = 1;
     DMC<Cpu_t> DMC1;
+
+    // Channels and scheduling, the output buffers and expansion sound are
+    // wiring
+    template <class State_t>
+    void Serialize(State_t & state) {
+        Frame.Serialize(state);
+        Pulse1.Serialize(state);
+        Pulse2.Serialize(state);
+        Triangle1.Serialize(state);
+        Noise1.Serialize(state);
+        DMC1.Serialize(state);
+        state(Pulse1Output, Pulse2Output, Triangle1Output, Noise1Output, DMC1Output,
+            PendingCycles, DeadlineCycles, level);
+    }
+
+    void SaveState(StateWriter & state) { Serialize(state); }
+    void LoadState(StateReader & state) { Serialize(state); }
+
+private:
+    float level = 0.0f;
+
+    void Emit(const float sample, const size_t count) {
+        if (Expansion == nullptr) {
+            Output(sample, count);
+            return;
+        }
+        for (size_t i = 0; i < count; ++i) Output(Expansion->Tick(sample), 1);
+    }
+
+    void Output(const float sample, const size_t count) {
+        if (Samples != nullptr) Samples->insert(Samples->end(), count, sample);
+        if (Blip != nullptr) {
+            if (sample != level) Blip->AddDelta(BlipTime, sample - level);
+            BlipTime += count;
+        }
+        level = sample;
+    }
 };
 
 #endif /* APU_H_ */
@@ -0,0 +1,131 @@
+/*
+ * BlipBuffer.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: scorder
+ */
+
+#ifndef BLIP_BUFFER_H_
+#define BLIP_BUFFER_H_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+// Band-limited step synthesis
+// The emulated source only reports amplitude changes with their clock
+// timestamp. Each change is added to the output as a windowed sinc step at
+// its exact fractional sample position so the signal is resampled to the
+// host rate without aliasing.
+
+class BlipBuffer {
+public:
+    static constexpr size_t PHASE_BITS = 5;
+    static constexpr size_t PHASES = size_t(1) << PHASE_BITS;
+    static constexpr size_t TAPS = 16;
+
+    explicit BlipBuffer(const size_t clockRate, const size_t sampleRate)
+        : Gain(20000.0f),
+        factor(Factor(clockRate, sampleRate)),
+        offset(0),
+        level(0.0f),
+        dc(0.0f),
+        deltas(TAPS, 0.0f) {
+        BuildKernel();
+    }
+
+    // Output scale from source amplitude to 16-bit samples
+    float Gain;
+
+    // Adds an amplitude change at time clocks into the current frame
+    void AddDelta(const size_t time, const float delta) {
+        const uint64_t position = offset + time * factor;
+        const size_t sample = size_t(position >> FRAC_BITS);
+        const size_t phase = size_t(position >> (FRAC_BITS - PHASE_BITS)) & (PHASES - 1);
+        if (sample + TAPS > deltas.size()) deltas.resize(sample + TAPS, 0.0f);
+        const auto & k = kernel[phase];
+        for (size_t i = 0; i < TAPS; ++i) deltas[sample + i] += delta * k[i];
+    }
+
+    // Ends the current frame after time clocks, its samples can be read
+    void EndFrame(const size_t time) {
+        offset += time * factor;
+        const size_t end = size_t(offset >> FRAC_BITS) + TAPS;
+        if (end > deltas.size()) deltas.resize(end, 0.0f);
+    }
+
+    size_t SamplesAvailable() const {
+        return size_t(offset >> FRAC_BITS);
+    }
+
+    // Reads up to count samples, returns how many were written
+    size_t ReadSamples(int16_t * out, const size_t count) {
+        const auto n = std::min(count, SamplesAvailable());
+        for (size_t i = 0; i < n; ++i) {
+            level += deltas[i];
+            // High-pass to remove the DC offset of the mixer
+            dc += (level - dc) * DC_BLOCK;
+            const auto value = std::lround((level - dc) * Gain);
+            out[i] = int16_t(std::max<long>(-32768, std::min<long>(32767, value)));
+        }
+        Remove(n);
+        return n;
+    }
+
+    // Drops the available samples
+    void Clear() {
+        const auto n = SamplesAvailable();
+        for (size_t i = 0; i < n; ++i) level += deltas[i];
+        dc = level;
+        Remove(n);
+    }
+
+private:
+    static constexpr size_t FRAC_BITS = 32;
+    static constexpr float DC_BLOCK = 1.0f / 2048.0f;
+
+    static uint64_t Factor(const size_t clockRate, const size_t sampleRate) {
+        return (uint64_t(sampleRate) << FRAC_BITS) / clockRate;
+    }
+
+    void Remove(const size_t n) {
+        deltas.erase(deltas.begin(), deltas.begin() + n);
+        if (deltas.size() < TAPS) deltas.resize(TAPS, 0.0f);
+        offset -= uint64_t(n) << FRAC_BITS;
+    }
+
+    // Blackman windowed sinc cut off a little below Nyquist, one set of taps
+    // per fractional position, each normalized to a unit step
+    void BuildKernel() {
+        static constexpr double PI = 3.14159265358979323846;
+        static constexpr double CUTOFF = 0.45;
+        const double half = TAPS / 2.0;
+        for (size_t phase = 0; phase < PHASES; ++phase) {
+            const double fraction = double(phase) / PHASES;
+            double sum = 0.0;
+            std::array<double, TAPS> taps;
+            for (size_t i = 0; i < TAPS; ++i) {
+                const double x = i + 0.5 - half - fraction;
+                const double sinc = (x == 0.0) ? 1.0 : std::sin(2.0 * PI * CUTOFF * x) / (2.0 * PI * CUTOFF * x);
+                const double w = (x + half) / TAPS;
+                const double window = (w <= 0.0 || w >= 1.0) ? 0.0
+                    : 0.42 - 0.5 * std::cos(2.0 * PI * w) + 0.08 * std::cos(4.0 * PI * w);
+                taps[i] = sinc * window;
+                sum += taps[i];
+            }
+            for (size_t i = 0; i < TAPS; ++i) kernel[phase][i] = float(taps[i] / sum);
+        }
+    }
+
+    uint64_t factor;    // Samples per clock, 32.32 fixed point
+    uint64_t offset;    // Start of the current frame in samples, 32.32
+    float level;
+    float dc;
+    std::vector<float> deltas;
+    std::array<std::array<float, TAPS>, PHASES> kernel;
+};
+
+#endif /* BLIP_BUFFER_H_ */
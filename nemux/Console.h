@@ -0,0 +1,183 @@
+/*
+ * Console.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: scorder
+ */
+
+#ifndef CONSOLE_H_
+#define CONSOLE_H_
+
+#include "Types.h"
+#include "Mapper.h"
+#include "MemoryMap.h"
+#include "Cpu.h"
+#include "Ppu.h"
+#include "Apu.h"
+#include "Controllers.h"
+#include "BlipBuffer.h"
+#include "State.h"
+
+#include <memory>
+#include <vector>
+
+// Complete console around a cartridge mapper
+// Components are interleaved one CPU cycle at a time: CPU, 3 PPU dots, APU
+// PPU dots and APU cycles are only owed per cycle and run in batches, see
+// Ppu::Schedule and Apu::Schedule
+// With a concrete Mapper_t the memory maps, PPU and mapper are all known at
+// compile time and the PPU fetches are inlined down to the cartridge memory,
+// Console<NesMapper> takes any mapper through virtual calls, see Machine.h
+template <class Mapper_t>
+class Console {
+public:
+    typedef PpuMemoryMap<Palette, Mapper_t> PpuMap_t;
+    typedef Ppu<PpuMap_t> Ppu_t;
+    typedef CpuMemoryMap<Cpu, Ppu_t, Controllers, Apu<Cpu>, Mapper_t> CpuMap_t;
+
+    Controllers ctrl;
+    std::unique_ptr<Mapper_t> mapper;
+    PpuMap_t ppumap;
+    Ppu_t ppu;
+    Apu<Cpu> apu;
+    CpuMap_t cpumap;
+    Cpu cpu;
+
+    // CPU cycles run since power up
+    size_t Cycles = 0;
+
+    // Mixed audio output resampled to the host rate
+    // Accumulates across runs until the caller reads or clears it
+    BlipBuffer Audio;
+
+    // Raw mixer output, one sample per CPU cycle, only kept on request
+    // Accumulates across runs until the caller clears it
+    std::vector<float> Samples;
+
+    void KeepSamples(const bool keep) {
+        apu.Samples = keep ? &Samples : nullptr;
+        if (keep) Samples.reserve(CYCLES_PER_FRAME + 1);
+    }
+
+    // Frames run ahead or again after loading a state are not heard, Audio
+    // gets nothing until unmuted
+    void MuteAudio(const bool mute) {
+        apu.Blip = mute ? nullptr : &Audio;
+    }
+
+    explicit Console(std::unique_ptr<Mapper_t> & cartridge, const size_t sampleRate = 48000)
+        : mapper(cartridge.release()),
+        ppumap(nullptr, mapper.get()),
+        ppu(&ppumap),
+        cpumap(nullptr, &apu, &ppu, mapper.get(), &ctrl),
+        cpu("6502", &cpumap),
+        Audio(CPU_CLOCK_RATE, sampleRate) {
+        cpumap.CPU = &cpu;
+        cpumap.MapCartridge();
+        cpu.NMILine = &ppu.NMIActive;
+        cpu.IRQLines = {{ &apu.Frame.Interrupt, &apu.DMC1.Output.DMA.Interrupt }};
+        apu.DMC1.Output.DMA.CPU = &cpu;
+        apu.Blip = &Audio;
+        if (mapper->HasExpansionAudio()) apu.Expansion = mapper.get();
+        cpu.PowerUp();
+    }
+    Console(const Console &) = delete;
+    Console & operator=(const Console &) = delete;
+
+    void Reset() { cpu.Reset(); }
+
+    void RunCycles(size_t cycles) {
+        while (cycles-- > 0) Cycle();
+        CatchUp();
+    }
+
+    // Runs until the PPU starts a new frame
+    void RunUntilFrame() {
+        const auto frame = ppu.FrameCount;
+        do {
+            Cycle();
+        } while (ppu.FrameCount == frame);
+        CatchUp();
+    }
+
+    // Runs until the current CPU instruction (or interrupt sequence) is done
+    void RunInstruction() {
+        do {
+            Cycle();
+        } while (cpu.CurrentTick < cpu.Ticks);
+        CatchUp();
+    }
+
+    // Runs whole instructions until PC reaches address
+    // Returns false if maxCycles elapsed first
+    bool RunUntilPC(const Word address, const size_t maxCycles) {
+        const auto limit = Cycles + maxCycles;
+        while (Cycles < limit) {
+            RunInstruction();
+            if (cpu.PC == address) return true;
+        }
+        return false;
+    }
+
+    // Snapshot of every component between two runs, see State.h
+    // Frame and audio output are not part of it
+    void SaveState(std::vector<Byte> & data) {
+        data.clear();
+        StateWriter state(data);
+        state(STATE_MAGIC, STATE_VERSION);
+        ctrl.SaveState(state);
+        mapper->SaveState(state);
+        ppumap.SaveState(state);
+        ppu.SaveState(state);
+        apu.SaveState(state);
+        cpumap.SaveState(state);
+        cpu.SaveState(state);
+        state(Cycles);
+    }
+
+    std::vector<Byte> SaveState() {
+        std::vector<Byte> data;
+        SaveState(data);
+        return data;
+    }
+
+    // Only states saved with the same cartridge can be loaded, the console
+    // is left half loaded when an exception is thrown
+    void LoadState(const std::vector<Byte> & data) {
+        StateReader state(data);
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        state(magic, version);
+        if (magic != STATE_MAGIC) throw invalid_format("Not a save state");
+        if (version != STATE_VERSION) throw unsupported_format("Unsupported save state version");
+        ctrl.LoadState(state);
+        mapper->LoadState(state);
+        ppumap.LoadState(state);
+        ppu.LoadState(state);
+        apu.LoadState(state);
+        cpumap.LoadState(state);
+        cpu.LoadState(state);
+        state(Cycles);
+        if (!state.AtEnd()) throw invalid_format("Save state of another cartridge");
+        cpumap.MapCartridge();
+    }
+
+    static constexpr size_t CYCLES_PER_FRAME = 29781;
+    static constexpr size_t CPU_CLOCK_RATE = 1789773;
+
+private:
+    void Cycle() {
+        ++Cycles;
+        cpu.Tick();
+        ppu.Schedule(3);
+        apu.Schedule(1);
+    }
+
+    void CatchUp() {
+        ppu.CatchUp();
+        apu.CatchUp();
+        apu.FlushAudio();
+    }
+};
+
+#endif /* CONSOLE_H_ */
@@ -3,6 +3,7 @@
 
 #include "Types.h"
 #include "BitUtil.h"
+#include "State.h"
 
 #include <array>
 
@@ -71,6 +72,16 @@ public:
     bool P2_Select = false;
     bool P2_A = false;
     bool P2_B = false;
+
+    template <class State_t>
+    void Serialize(State_t & state) {
+        state(Strobe,
+            P1_Latch, P1_Up, P1_Down, P1_Left, P1_Right, P1_Start, P1_Select, P1_A, P1_B,
+            P2_Latch, P2_Up, P2_Down, P2_Left, P2_Right, P2_Start, P2_Select, P2_A, P2_B);
+    }
+
+    void SaveState(StateWriter & state) { Serialize(state); }
+    void LoadState(StateReader & state) { Serialize(state); }
 };
 
 #endif /* CONTROLLERS_H_ */
@@ -7,8 +7,6 @@
 #include "Cpu.h"
 
 #include "BitUtil.h"
-#include "Ppu.h"
-#include "Controllers.h"
 
 #include <iomanip>
 #include <sstream>
@@ -19,27 +17,15 @@ using namespace Instructions;
 using namespace Addressing;
 
 static const bool USE_RP2A03 = true;
-static int nmic = 0;
-static void Write2A03State(Cpu& cpu, Ricoh_RP2A03& rp2a03) {
+
+// Registers are shared with the RP2A03 so only the state it does not
+// model (break flag, halted line, instruction boundary) is synchronised
+static void Enter2A03(Cpu& cpu, Ricoh_RP2A03& rp2a03) {
     rp2a03.Halted = !cpu.IsAlive;
-    rp2a03.PC = cpu.PC;
-    rp2a03.S = cpu.SP;
-    rp2a03.A = cpu.A;
-    rp2a03.X = cpu.X;
-    rp2a03.Y = cpu.Y;
-    rp2a03.SetStatus(cpu.GetStatus());
-    rp2a03.Map = cpu.Map;
-    rp2a03.Ticks = cpu.Ticks;
 }
-static void Read2A03State(Ricoh_RP2A03& rp2a03, Cpu& cpu) {
-    cpu.Ticks = rp2a03.Ticks;
+static void Leave2A03(Ricoh_RP2A03& rp2a03, Cpu& cpu) {
     if (rp2a03.INSTR) cpu.CurrentTick = rp2a03.Ticks;
-    cpu.PC = rp2a03.PC;
-    cpu.SP = rp2a03.S;
-    cpu.A = rp2a03.A;
-    cpu.X = rp2a03.X;
-    cpu.Y = rp2a03.Y;
-    cpu.SetStatus(rp2a03.GetStatus(0));
+    cpu.B = 0;
     cpu.IsAlive = !rp2a03.Halted;
 }
 
@@ -64,9 +50,16 @@ void Cpu::WriteByteAt(const Word address, const Byte value) {
 
 /* explicit */ Cpu::Cpu(std::string name, MemoryMap * map)
     : Name{name},
-      PC {0}, SP {0}, A {0}, X {0}, Y {0},
-      C {0}, Z {0}, I {0}, D {0}, B {0}, V {0}, N {0}, Unused{1},
-      Ticks{0}, InterruptCycles{7}, Map{map} {
+      PC {rp2a03.PC}, SP {rp2a03.S}, A {rp2a03.A}, X {rp2a03.X}, Y {rp2a03.Y},
+      C {rp2a03.C}, Z {rp2a03.Z}, I {rp2a03.I}, D {rp2a03.D}, B {0},
+      V {rp2a03.V}, N {rp2a03.N}, Unused{1},
+      Ticks{rp2a03.Ticks}, InterruptCycles{7},
+      FastPath{rp2a03.FastPath}, Map{rp2a03.Map} {
+    PC = 0; SP = 0; A = 0; X = 0; Y = 0;
+    C = Z = I = D = V = N = 0;
+    Ticks = 0;
+    Map = map;
+
     m_opcodes.resize(
         OPCODES_COUNT,
         Opcode(UNK, Unknown, 0, 0)
@@ -422,13 +415,7 @@ void Cpu::WriteByteAt(const Word address, const Byte value) {
 void Cpu::Tick() {
     if (!USE_RP2A03) {
         ++CurrentTick;
-        static auto m = dynamic_cast<CpuMemoryMap<Cpu, Ppu, Controllers, Apu<Cpu>> *>(Map);
-        static bool nmi = false;
-        static bool nmiDelayed1 = false;
-        static bool nmiDelayed2 = false;
-        static bool nmiDelayed3 = false;
-        static bool nmiDelayed4 = false;
-        if (m != nullptr) {
+        if (NMILine != nullptr) {
             if (!nmiDelayed4 && nmiDelayed3) {
                 TriggerNMI();
             }
@@ -436,11 +423,9 @@ void Cpu::Tick() {
             nmiDelayed3 = nmiDelayed2;
             nmiDelayed2 = nmiDelayed1;
             nmiDelayed1 = nmi;
-            nmi = m->PPU->NMIActive;
+            nmi = *NMILine;
 
-            if (I == 0 && (
-                m->APU->Frame.Interrupt ||
-                m->APU->DMC1.Output.DMA.Interrupt)) {
+            if (I == 0 && IsIRQActive()) {
                 TriggerIRQ();
             }
 
@@ -463,19 +448,24 @@ void Cpu::Tick() {
         }
     }
     else {
-        Write2A03State(*this, rp2a03);
+        Enter2A03(*this, rp2a03);
         rp2a03.Phi1();
-        static auto m = dynamic_cast<CpuMemoryMap<Cpu, Ppu, Controllers, Apu<Cpu>> *>(Map);
-        if (m != nullptr) {
-            rp2a03.NMI = m->PPU->NMIActive;
-            rp2a03.IRQ = (I == 0)
-                && (m->APU->Frame.Interrupt || m->APU->DMC1.Output.DMA.Interrupt);
+        if (NMILine != nullptr) {
+            rp2a03.NMI = *NMILine;
+            rp2a03.IRQ = (I == 0) && IsIRQActive();
         }
         rp2a03.Phi2();
-        Read2A03State(rp2a03, *this);
+        Leave2A03(rp2a03, *this);
     }
 }
 
+bool Cpu::IsIRQActive() const {
+    for (const auto line : IRQLines) {
+        if (line != nullptr && *line) return true;
+    }
+    return false;
+}
+
 Opcode Cpu::Decode(const Byte &byte) const {
     if (0 <= byte && byte < OPCODES_COUNT)
         return m_opcodes[byte];
@@ -647,7 +637,6 @@ void Cpu::Reset() {
     }
 }
 void Cpu::NMI() {
-    std::cout << "NMI " << nmic++ << std::endl;
     PendingInterrupt = InterruptType::None;
     Interrupt(0, VectorNMI);
 }
@@ -673,9 +662,9 @@ void Cpu::DMA(const Byte page,
     std::array<Byte, 0x0100> & target,
     const Byte offset) {
     if (USE_RP2A03) {
-        Write2A03State(*this, rp2a03);
+        Enter2A03(*this, rp2a03);
         rp2a03.DMA(page, target.data(), offset);
-        Read2A03State(rp2a03, *this);
+        Leave2A03(rp2a03, *this);
     }
     else {
         const Word base = page << BYTE_WIDTH;
@@ -688,9 +677,19 @@ void Cpu::DMA(const Byte page,
         }
     }
 }
+void Cpu::SaveState(StateWriter & state) const {
+    rp2a03.SaveState(state);
+    state(IsAlive, B, InterruptCycles, CurrentTick, PendingInterrupt,
+        nmi, nmiDelayed1, nmiDelayed2, nmiDelayed3, nmiDelayed4);
+}
+void Cpu::LoadState(StateReader & state) {
+    rp2a03.LoadState(state);
+    state(IsAlive, B, InterruptCycles, CurrentTick, PendingInterrupt,
+        nmi, nmiDelayed1, nmiDelayed2, nmiDelayed3, nmiDelayed4);
+}
 void Cpu::Execute(const Opcode &op) {
     if (USE_RP2A03) {
-        Write2A03State(*this, rp2a03);
+        Enter2A03(*this, rp2a03);
 
         int hexa;
         for (hexa = 0; hexa < 0x100; ++hexa) {
@@ -706,7 +705,7 @@ void Cpu::Execute(const Opcode &op) {
             rp2a03.Phi2();
         } while (!rp2a03.INSTR);
         
-        Read2A03State(rp2a03, *this);
+        Leave2A03(rp2a03, *this);
         return;
     }
     if (!IsAlive) return;
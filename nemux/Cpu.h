@@ -92,6 +92,7 @@ struct address_t {
 };
 
 class Cpu {
+    // Register file owner, Cpu registers below are views over its state
     Ricoh_RP2A03 rp2a03;
 public:
     bool IsAlive;
@@ -102,22 +103,24 @@ public:
     void WriteByteAt(const Word address, const Byte value);
 
     explicit Cpu(std::string name, MemoryMap * map = nullptr);
+    Cpu(const Cpu &) = delete;
+    Cpu & operator=(const Cpu &) = delete;
 
     std::string Name;
 
-    Word PC; // Program Counter
-    Byte SP; // Stack Pointer
-    Byte A;  // Accumulator
-    Byte X;  // Index Register X
-    Byte Y;  // Index Register Y
-
-    Flag C; // Carry Flag
-    Flag Z; // Zero Flag
-    Flag I; // Interrupt Disable
-    Flag D; // Decimal Mode
-    Flag B; // Break Command
-    Flag V; // Overflow Flag
-    Flag N; // Negative Flag
+    Word & PC; // Program Counter
+    Byte & SP; // Stack Pointer
+    Byte & A;  // Accumulator
+    Byte & X;  // Index Register X
+    Byte & Y;  // Index Register Y
+
+    Flag & C; // Carry Flag
+    Flag & Z; // Zero Flag
+    Flag & I; // Interrupt Disable
+    Flag & D; // Decimal Mode
+    Flag B;   // Break Command
+    Flag & V; // Overflow Flag
+    Flag & N; // Negative Flag
     const Flag Unused;
 
     Word StackPage = 0x0100;
@@ -125,17 +128,20 @@ public:
     Word VectorNMI = 0xFFFA;
     Word VectorIRQ = 0xFFFE;
 
-    int Ticks;
+    size_t & Ticks;
     int InterruptCycles;
 
-    int CurrentTick;
+    size_t CurrentTick;
     void Tick();
 
+    // Instruction-granular execution, see Ricoh_RP2A03::FastPath
+    bool & FastPath;
+
     Opcode Decode(const Byte &byte) const;
     address_t BuildAddress(const Addressing::Type & type) const;
     void Execute(const Opcode &op);//, const std::vector<Byte> &data);
 
-    MemoryMap * Map;
+    MemoryMap *& Map;
 
     std::string ToString() const;
     std::string ToMiniString() const;
@@ -167,18 +173,33 @@ public:
     void IRQ();
 
     InterruptType PendingInterrupt;
+    // Interrupt request lines sampled every cycle, wired by the console,
+    // nullptr when not connected
+    const bool * NMILine = nullptr;
+    std::array<const bool *, 2> IRQLines = {{ nullptr, nullptr }};
     void TriggerReset();
     void TriggerNMI();
     void TriggerIRQ();
+    bool IsIRQActive() const;
 
     void DMA(const Byte page, std::array<Byte, 0x0100> & target, const Byte offset);
 
+    void SaveState(StateWriter & state) const;
+    void LoadState(StateReader & state);
+
 private:
 //    std::vector<Instruction> m_opcodes;
 //    std::vector<Opsize> m_opsize;
 //    std::vector<Optime> m_optime;
 //    std::vector<Addressing> m_opaddr;
     std::vector<Opcode> m_opcodes;
+
+    // NMI line history, the legacy core sees an edge a few cycles late
+    bool nmi = false;
+    bool nmiDelayed1 = false;
+    bool nmiDelayed2 = false;
+    bool nmiDelayed3 = false;
+    bool nmiDelayed4 = false;
 };
 
 #endif /* CPU_H_ */
@@ -0,0 +1,63 @@
+/*
+ * FrameExchange.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: scorder
+ */
+
+#ifndef FRAME_EXCHANGE_H_
+#define FRAME_EXCHANGE_H_
+
+#include <array>
+#include <atomic>
+
+// Triple buffer between exactly one producer thread drawing frames and one
+// consumer thread presenting them, neither ever waits for the other
+// The producer draws into Back and publishes it by swapping its index with
+// the middle one, the consumer takes the latest published frame the same
+// way, so no frame is copied; a frame published again before being taken
+// is dropped
+template <typename _T>
+class FrameExchange {
+    static constexpr size_t INDEX = 0x03;
+    // Set in middle until the consumer takes the frame published there
+    static constexpr size_t FRESH = 0x04;
+
+    std::array<_T, 3> buffers;
+    size_t back;
+    alignas(64) std::atomic<size_t> middle;
+    alignas(64) size_t front;
+
+public:
+    explicit FrameExchange() : back(0), middle(1), front(2), Published(0), Dropped(0) {}
+
+    // Frames published by the producer
+    std::atomic<size_t> Published;
+    // Frames published again before the consumer took them
+    std::atomic<size_t> Dropped;
+
+    // Producer side, the frame being drawn
+    _T & Back() { return buffers[back]; }
+
+    // Producer side, the drawn frame goes to the consumer and Back becomes
+    // the oldest one it does not hold
+    void Publish() {
+        const auto previous = middle.exchange(back | FRESH, std::memory_order_acq_rel);
+        back = previous & INDEX;
+        Published.fetch_add(1, std::memory_order_relaxed);
+        if ((previous & FRESH) != 0) Dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Consumer side, returns false while no frame newer than Front was
+    // published
+    bool Take() {
+        if ((middle.load(std::memory_order_relaxed) & FRESH) == 0) return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    // Consumer side, the frame taken last
+    const _T & Front() const { return buffers[front]; }
+};
+
+#endif /* FRAME_EXCHANGE_H_ */
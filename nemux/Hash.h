@@ -0,0 +1,192 @@
+/*
+ * Hash.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: scorder
+ */
+
+#ifndef HASH_H_
+#define HASH_H_
+
+#include "Types.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// 64-bit FNV-1a, stable across runs and hosts, values are hashed one at a
+// time whatever their width
+struct Fnv1a {
+    uint64_t Value = 14695981039346656037ULL;
+
+    template <class T>
+    void Add(const T * data, const size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            Value = (Value ^ uint64_t(data[i])) * 1099511628211ULL;
+        }
+    }
+};
+
+// 64-bit xxHash (XXH64), stable across runs and hosts for byte data
+// Four independent lanes take 32 bytes per round so the multiplies of a
+// round overlap, a whole frame hashes in a few microseconds
+// Wider values are hashed in host byte order, little endian on every host
+// nemux runs on, and a hash can be the seed of the next one to chain blocks
+class Xxh64 {
+public:
+    static uint64_t Of(const void * data, const size_t size, const uint64_t seed = 0) {
+        const Byte * p = static_cast<const Byte *>(data);
+        const Byte * const end = p + size;
+        uint64_t h;
+        if (size >= 32) {
+            uint64_t v1 = seed + P1 + P2;
+            uint64_t v2 = seed + P2;
+            uint64_t v3 = seed;
+            uint64_t v4 = seed - P1;
+            for (const Byte * const limit = end - 32; p <= limit; p += 32) {
+                v1 = Round(v1, Read64(p));
+                v2 = Round(v2, Read64(p + 8));
+                v3 = Round(v3, Read64(p + 16));
+                v4 = Round(v4, Read64(p + 24));
+            }
+            h = Rotate(v1, 1) + Rotate(v2, 7) + Rotate(v3, 12) + Rotate(v4, 18);
+            h = Merge(h, v1);
+            h = Merge(h, v2);
+            h = Merge(h, v3);
+            h = Merge(h, v4);
+        } else {
+            h = seed + P5;
+        }
+        h += uint64_t(size);
+        for (; p + 8 <= end; p += 8) h = Rotate(h ^ Round(0, Read64(p)), 27) * P1 + P4;
+        if (p + 4 <= end) {
+            h = Rotate(h ^ (Read32(p) * P1), 23) * P2 + P3;
+            p += 4;
+        }
+        for (; p < end; ++p) h = Rotate(h ^ (*p * P5), 11) * P1;
+        h ^= h >> 33;
+        h *= P2;
+        h ^= h >> 29;
+        h *= P3;
+        h ^= h >> 32;
+        return h;
+    }
+
+    template <class T, size_t N>
+    static uint64_t Of(const std::array<T, N> & values, const uint64_t seed = 0) {
+        return Of(values.data(), N * sizeof(T), seed);
+    }
+
+    template <class T>
+    static uint64_t Of(const std::vector<T> & values, const uint64_t seed = 0) {
+        return Of(values.data(), values.size() * sizeof(T), seed);
+    }
+
+private:
+    static constexpr uint64_t P1 = 0x9E3779B185EBCA87ULL;
+    static constexpr uint64_t P2 = 0xC2B2AE3D27D4EB4FULL;
+    static constexpr uint64_t P3 = 0x165667B19E3779F9ULL;
+    static constexpr uint64_t P4 = 0x85EBCA77C2B2AE63ULL;
+    static constexpr uint64_t P5 = 0x27D4EB2F165667C5ULL;
+
+    static uint64_t Rotate(const uint64_t x, const int n) { return (x << n) | (x >> (64 - n)); }
+
+    static uint64_t Round(const uint64_t acc, const uint64_t input) { return Rotate(acc + input * P2, 31) * P1; }
+
+    static uint64_t Merge(const uint64_t h, const uint64_t v) { return (h ^ Round(0, v)) * P1 + P4; }
+
+    // Little endian loads, compilers turn them into plain loads
+    static uint64_t Read64(const Byte * p) { return Read32(p) | (Read32(p + 4) << 32); }
+
+    static uint64_t Read32(const Byte * p) {
+        return uint64_t(p[0]) | (uint64_t(p[1]) << 8) | (uint64_t(p[2]) << 16) | (uint64_t(p[3]) << 24);
+    }
+};
+
+// SHA-1 of a whole file, identifies the ROM a movie was recorded with
+class Sha1 {
+public:
+    typedef std::array<Byte, 20> Digest;
+
+    Sha1() : length(0), buffered(0) {
+        state = {{ 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 }};
+    }
+
+    void Add(const Byte * data, size_t count) {
+        length += count;
+        while (count > 0) {
+            const auto n = std::min(count, block.size() - buffered);
+            std::memcpy(block.data() + buffered, data, n);
+            buffered += n;
+            data += n;
+            count -= n;
+            if (buffered == block.size()) {
+                Compress();
+                buffered = 0;
+            }
+        }
+    }
+
+    Digest Finish() {
+        const uint64_t bits = length * 8;
+        const Byte pad = 0x80;
+        Add(&pad, 1);
+        const Byte zero = 0x00;
+        while (buffered != 56) Add(&zero, 1);
+        for (int i = 7; i >= 0; --i) {
+            const auto b = Byte(bits >> (8 * i));
+            Add(&b, 1);
+        }
+        Digest digest;
+        for (size_t i = 0; i < digest.size(); ++i) digest[i] = Byte(state[i / 4] >> (24 - 8 * (i % 4)));
+        return digest;
+    }
+
+    static Digest Of(const std::string & data) {
+        Sha1 sha1;
+        sha1.Add(reinterpret_cast<const Byte *>(data.data()), data.size());
+        return sha1.Finish();
+    }
+
+private:
+    std::array<uint32_t, 5> state;
+    std::array<Byte, 64> block;
+    uint64_t length;
+    size_t buffered;
+
+    static uint32_t Rotate(const uint32_t x, const int n) { return (x << n) | (x >> (32 - n)); }
+
+    void Compress() {
+        std::array<uint32_t, 80> w;
+        for (size_t i = 0; i < 16; ++i) {
+            w[i] = uint32_t(block[4 * i]) << 24 | uint32_t(block[4 * i + 1]) << 16
+                | uint32_t(block[4 * i + 2]) << 8 | uint32_t(block[4 * i + 3]);
+        }
+        for (size_t i = 16; i < 80; ++i) w[i] = Rotate(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+        auto a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+        for (size_t i = 0; i < 80; ++i) {
+            uint32_t f, k;
+            if (i < 20)      { f = (b & c) | (~b & d);          k = 0x5A827999; }
+            else if (i < 40) { f = b ^ c ^ d;                   k = 0x6ED9EBA1; }
+            else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+            else             { f = b ^ c ^ d;                   k = 0xCA62C1D6; }
+            const auto t = Rotate(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = Rotate(b, 30);
+            b = a;
+            a = t;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+    }
+};
+
+#endif /* HASH_H_ */
@@ -0,0 +1,51 @@
+/*
+ * Machine.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: scorder
+ */
+
+#ifndef MACHINE_H_
+#define MACHINE_H_
+
+#include "Console.h"
+#include "Error.h"
+#include "NesFile.h"
+#include "NsfFile.h"
+#include "Mapper_0.h"
+#include "Mapper_1.h"
+#include "Mapper_2.h"
+#include "Mapper_3.h"
+#include "Mapper_Nsf.h"
+
+#include <memory>
+
+// Console for any cartridge mapper, dispatched at run time
+typedef Console<NesMapper> Machine;
+
+template <class Mapper_t, class Rom_t, class Session_t>
+void WithConsoleFor(const Rom_t & rom, Session_t & session, const size_t sampleRate) {
+    std::unique_ptr<Mapper_t> mapper(new Mapper_t(rom));
+    Console<Mapper_t> console(mapper, sampleRate);
+    session(console);
+}
+
+// Builds the console instantiated for the iNES mapper of the rom and hands
+// it to session, which is called as session(Console<Mapper_t> &)
+template <class Session_t>
+void WithConsole(const NesFile & rom, Session_t & session, const size_t sampleRate = 48000) {
+    switch (rom.Header.MapperNumber) {
+    case 0: WithConsoleFor<Mapper_000>(rom, session, sampleRate); break;
+    case 1: WithConsoleFor<Mapper_001>(rom, session, sampleRate); break;
+    case 2: WithConsoleFor<Mapper_002>(rom, session, sampleRate); break;
+    case 3: WithConsoleFor<Mapper_003>(rom, session, sampleRate); break;
+    default: throw unsupported_format("Unsupported mapper");
+    }
+}
+
+template <class Session_t>
+void WithConsole(const NsfFile & nsf, Session_t & session, const size_t sampleRate = 48000) {
+    WithConsoleFor<Mapper_NSF>(nsf, session, sampleRate);
+}
+
+#endif /* MACHINE_H_ */
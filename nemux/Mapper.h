@@ -12,6 +12,8 @@
 #include <vector>
 
 #include "Types.h"
+#include "PageTable.h"
+#include "State.h"
 
 class NesMapper {
 public:
@@ -27,6 +29,27 @@ public:
     virtual void SetPpuAt(const Word address, const Byte value) = 0;
 
     virtual float Tick(const float audioCPU) { return audioCPU; }
+
+    // Tick() needs to be called for every audio sample
+    virtual bool HasExpansionAudio() const { return false; }
+
+    // Maps the CPU pages from $4400 up that read (or write) plain memory,
+    // called again whenever PrgGeneration changes
+    virtual void MapCpuPages(PageTable & /*pages*/) {}
+
+    // Maps the pattern table pages ($0000-$1FFF) of the current CHR banks,
+    // called again whenever ChrGeneration changes
+    virtual void MapPpuPages(PageTable & /*pages*/) {}
+
+    // Bank registers and cartridge RAM, loading switches PRG banks
+    virtual void SaveState(StateWriter & /*state*/) {}
+    virtual void LoadState(StateReader & /*state*/) {}
+
+    // Changes whenever the PRG banks seen at $8000-$FFFF are switched
+    size_t PrgGeneration = 0;
+
+    // Changes whenever the CHR banks seen at $0000-$1FFF are switched
+    size_t ChrGeneration = 0;
 };
 
 #endif /* MAPPER_H_ */
@@ -10,7 +10,7 @@ struct BankedAddress {
     Word Address;
 };
 
-class Mapper_000 : public NesMapper {
+class Mapper_000 final : public NesMapper {
 public:
     explicit Mapper_000(const NesFile & rom) {
         if (rom.Header.MapperNumber != 0) throw invalid_format("Invalid mapper");
@@ -25,6 +25,7 @@ public:
         PrgRom = rom.PrgRomPages;
         IsReadOnly = (rom.Header.ChrRomPages > 0);
         if (IsReadOnly) ChrRom = rom.ChrRomPages[0];
+        else ChrRom.fill(0);
     }
 
     virtual ~Mapper_000() {}
@@ -54,6 +55,16 @@ public:
 
     }
 
+    void MapCpuPages(PageTable & pages) override {
+        pages.MapRead(0x8000, 0x4000, PrgRom[0].data());
+        pages.MapRead(0xC000, 0x4000, PrgRom[Mirror ? 0 : 1].data());
+    }
+
+    void MapPpuPages(PageTable & pages) override {
+        if (IsReadOnly) pages.MapRead(0x0000, ChrRom.size(), ChrRom.data());
+        else pages.MapReadWrite(0x0000, ChrRom.size(), ChrRom.data());
+    }
+
     Byte GetPpuAt(const Word address) const override {
         const Word addr = TranslatePpu(address);
         return ChrRom[addr];
@@ -63,6 +74,14 @@ public:
         if (!IsReadOnly) ChrRom[TranslatePpu(address)] = value;
     }
 
+    void SaveState(StateWriter & state) override {
+        if (!IsReadOnly) state(ChrRom);
+    }
+
+    void LoadState(StateReader & state) override {
+        if (!IsReadOnly) state(ChrRom);
+    }
+
 private:
     bool Mirror;
     bool Horizontal;
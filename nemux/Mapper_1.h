@@ -7,7 +7,7 @@
 
 #include <algorithm>
 
-class Mapper_001 : public NesMapper {
+class Mapper_001 final : public NesMapper {
 public:
     enum class CpuAddressType {
         Unexpected,
@@ -120,6 +120,8 @@ public:
 
         HasPrgRam = true;
         HasChrRam = (rom.Header.ChrRomPages == 0);
+        PrgRam.fill(0);
+        ChrRam.fill(0);
     }
 
     virtual ~Mapper_001() {}
@@ -208,7 +210,11 @@ public:
         return{ MMCRegister::None, 0x00 };
     }
 
+    // The generations only change with the banks seen, games rewrite the
+    // registers far more often than they switch banks
     void WriteControl(const Byte value) {
+        const auto prgMode = PrgMode;
+        const auto chrMode = ChrMode;
         switch (value & 0x03) {
         case 0: ScreenMode = Mirroring::Screen0; break;
         case 1: ScreenMode = Mirroring::Screen1; break;
@@ -222,32 +228,41 @@ public:
         case 2: PrgMode = PRGBankingMode::SwitchLastBank; break;
         case 3: PrgMode = PRGBankingMode::SwitchFirstBank; break;
         }
+        if (PrgMode != prgMode) ++PrgGeneration;
 
         switch ((value >> 4) & 0x01) {
         case 0: ChrMode = CHRBankingMode::OneBank; break;
         case 1: ChrMode = CHRBankingMode::TwoBanks; break;
         }
+        if (ChrMode != chrMode) ++ChrGeneration;
     }
 
     void WriteCHR0(const Byte value) {
+        const auto bank = ChrBank0;
         if (ChrMode == CHRBankingMode::OneBank) ChrBank0 = (value & 0x1E);
         if (ChrMode == CHRBankingMode::TwoBanks) ChrBank0 = (value & 0x1F);
         if (ChrBanks.size() > 0)
             ChrBank0 = (ChrBank0 % ChrBanks.size());
+        if (ChrBank0 != bank) ++ChrGeneration;
     }
 
     void WriteCHR1(const Byte value) {
+        const auto bank = ChrBank1;
         if (ChrMode == CHRBankingMode::TwoBanks)
             if (ChrBanks.size() > 0)
                 ChrBank1 = ((value & 0x1F) % ChrBanks.size());
+        if (ChrBank1 != bank) ++ChrGeneration;
     }
 
     void WritePRG(const Byte value) {
+        const auto bank = PrgBank;
+        const auto hasPrgRam = HasPrgRam;
         if (PrgMode == PRGBankingMode::SwitchAllBanks) PrgBank = value & 0x0E;
         else PrgBank = value & 0x0F;
         PrgBank = (PrgBank % PrgBanks.size());
 
         HasPrgRam = IsBitClear<4>(value);
+        if ((PrgBank != bank) || (HasPrgRam != hasPrgRam)) ++PrgGeneration;
     }
 
     Byte GetCpuAt(const Word address) const override {
@@ -286,6 +301,25 @@ public:
         }
     }
 
+    void MapCpuPages(PageTable & pages) override {
+        if (HasPrgRam) pages.MapReadWrite(0x6000, PrgRam.size(), PrgRam.data());
+        for (const Word address : { Word(0x8000), Word(0xC000) }) {
+            const auto bank = ToPrgRom(address).Bank;
+            if (bank < PrgBanks.size()) pages.MapRead(address, 0x4000, PrgBanks[bank].data());
+        }
+    }
+
+    void MapPpuPages(PageTable & pages) override {
+        if (HasChrRam) {
+            pages.MapReadWrite(0x0000, ChrRam.size(), ChrRam.data());
+            return;
+        }
+        for (const Word address : { Word(0x0000), Word(0x1000) }) {
+            const auto bank = ToChrRom(address).Bank;
+            if (bank < ChrBanks.size()) pages.MapRead(address, 0x1000, ChrBanks[bank].data());
+        }
+    }
+
     Byte GetPpuAt(const Word address) const override {
         if (HasChrRam) {
             const auto addr = ToChrRam(address);
@@ -306,6 +340,21 @@ public:
             ChrRam[addr] = value;
         }
     }
+
+    template <class State_t>
+    void Serialize(State_t & state) {
+        state(ScreenMode, PrgMode, ChrMode, PrgBank, ChrBank0, ChrBank1,
+            HasPrgRam, PrgRam, Register, RegisterBit);
+        if (HasChrRam) state(ChrRam);
+    }
+
+    void SaveState(StateWriter & state) override { Serialize(state); }
+
+    void LoadState(StateReader & state) override {
+        Serialize(state);
+        ++PrgGeneration;
+        ++ChrGeneration;
+    }
 };
 
 #endif /* MAPPER_1_H_ */
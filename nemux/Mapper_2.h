@@ -5,7 +5,7 @@
 #include "MemoryMap.h"
 #include "NesFile.h"
 
-class Mapper_002 : public NesMapper {
+class Mapper_002 final : public NesMapper {
 public:
     struct BankedAddress {
         unsigned int Bank;
@@ -28,6 +28,7 @@ public:
         Horizontal = (rom.Header.ScreenMode == NesFile::HeaderDesc::HorizontalMirroring);
         Mirror = (rom.Header.PrgRomPages == 1);
         PrgRom = rom.PrgRomPages;
+        ChrRam.fill(0);
     }
 
     virtual ~Mapper_002() {}
@@ -55,6 +56,16 @@ public:
 
     void SetCpuAt(const Word address, const Byte value) override {
         CurrentBank = value;
+        ++PrgGeneration;
+    }
+
+    void MapCpuPages(PageTable & pages) override {
+        if (CurrentBank < PrgRom.size()) pages.MapRead(0x8000, 0x4000, PrgRom[CurrentBank].data());
+        pages.MapRead(0xC000, 0x4000, PrgRom.back().data());
+    }
+
+    void MapPpuPages(PageTable & pages) override {
+        pages.MapReadWrite(0x0000, ChrRam.size(), ChrRam.data());
     }
 
     Byte GetPpuAt(const Word address) const override {
@@ -67,6 +78,15 @@ public:
         ChrRam[addr] = value;
     }
 
+    void SaveState(StateWriter & state) override {
+        state(CurrentBank, ChrRam);
+    }
+
+    void LoadState(StateReader & state) override {
+        state(CurrentBank, ChrRam);
+        ++PrgGeneration;
+    }
+
 private:
     bool Mirror;
     bool Horizontal;
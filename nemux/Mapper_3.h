@@ -7,7 +7,7 @@
 
 #include <algorithm>
 
-class Mapper_003 : public NesMapper {
+class Mapper_003 final : public NesMapper {
 public:
     enum class CpuAddressType {
         Unexpected,
@@ -68,6 +68,7 @@ public:
 
         ChrBank = 0;
         HasChrRam = (rom.Header.ChrRomPages == 0);
+        ChrRam.fill(0);
     }
 
     virtual ~Mapper_003() {}
@@ -93,6 +94,7 @@ public:
     void WriteToCNROM(const Word address, const Byte value) {
         if (address < 0x8000) return;
         ChrBank = ((value & 0x03) % ChrBanks.size());
+        ++ChrGeneration;
     }
 
     Byte GetCpuAt(const Word address) const override {
@@ -108,6 +110,16 @@ public:
         WriteToCNROM(address, value);
     }
 
+    void MapCpuPages(PageTable & pages) override {
+        pages.MapRead(0x8000, 0x4000, PrgBanks[ToPrgRom(0x8000).Bank].data());
+        pages.MapRead(0xC000, 0x4000, PrgBanks[ToPrgRom(0xC000).Bank].data());
+    }
+
+    void MapPpuPages(PageTable & pages) override {
+        if (HasChrRam) pages.MapReadWrite(0x0000, ChrRam.size(), ChrRam.data());
+        else if (ChrBank < ChrBanks.size()) pages.MapRead(0x0000, 0x2000, ChrBanks[ChrBank].data());
+    }
+
     Byte GetPpuAt(const Word address) const override {
         if (HasChrRam) {
             const auto addr = ToChrRam(address);
@@ -125,6 +137,18 @@ public:
             ChrRam[addr] = value;
         }
     }
+
+    template <class State_t>
+    void Serialize(State_t & state) {
+        state(ChrBank);
+        if (HasChrRam) state(ChrRam);
+    }
+
+    void SaveState(StateWriter & state) override { Serialize(state); }
+    void LoadState(StateReader & state) override {
+        Serialize(state);
+        ++ChrGeneration;
+    }
 };
 
 #endif /* MAPPER_3_H_ */
@@ -5,9 +5,9 @@
 //#include "MemoryMap.h"
 #include "NsfFile.h"
 #include "VRC6_Audio.h"
-//#include <algorithm>
+#include <algorithm>
 
-class Mapper_NSF : public NesMapper {
+class Mapper_NSF final : public NesMapper {
 public:
 #define INVALID_BANK Byte(-1)
     bool IsBanked;
@@ -152,6 +152,15 @@ public:
         }
     }
 
+    // The last page holds the vectors of the player
+    void MapCpuPages(PageTable & pages) override {
+        pages.MapReadWrite(0x6000, Ram.size(), Ram.data());
+        for (Word address = 0x8000; address < 0xFC00; address += PageTable::PAGE_SIZE) {
+            const size_t offset = Translate(address);
+            if (offset + PageTable::PAGE_SIZE <= Rom.size()) pages.MapRead(address, PageTable::PAGE_SIZE, Rom.data() + offset);
+        }
+    }
+
     Byte GetPpuAt(const Word address) const override { return 0; }
 
     void SetPpuAt(const Word address, const Byte value) override {}
@@ -197,6 +206,7 @@ public:
 
     void SetBank(const Byte index, const Byte bank) {
         Banks[index] = bank;
+        ++PrgGeneration;
     }
 
     Word Translate(const Word addr) const {
@@ -210,6 +220,22 @@ public:
         }
         return audioCPU;
     }
+
+    bool HasExpansionAudio() const override { return UsesVRC6; }
+
+    // The player software is saved whole for the variables at its start
+    template <class State_t>
+    void Serialize(State_t & state) {
+        state(Banks, Ram, PlayerSoftware);
+        VRC6.Serialize(state);
+    }
+
+    void SaveState(StateWriter & state) override { Serialize(state); }
+
+    void LoadState(StateReader & state) override {
+        Serialize(state);
+        ++PrgGeneration;
+    }
 };
 
 #endif /* MAPPER_NSF_H_ */
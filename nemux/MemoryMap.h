@@ -14,6 +14,14 @@ struct MemoryMap {
 
     virtual Byte GetByteAt(const Word address) const = 0;
     virtual void SetByteAt(const Word address, const Byte value) = 0;
+
+    // Generation of the read-only code at $8000-$FFFF, nullptr when that
+    // range may be written to like any memory
+    virtual const size_t * PrgGeneration() const { return nullptr; }
+
+    // Pages that can be accessed without GetByteAt/SetByteAt, nullptr when
+    // every access must go through them
+    virtual const PageTable * DirectPages() const { return nullptr; }
 };
 
 template <std::size_t Size>
@@ -32,26 +40,55 @@ public:
     }
 };
 
-template <class Cpu_t, class Ppu_t, class Controllers_t, class Apu_t>
-class CpuMemoryMap : public MemoryMap {
+// Mapper_t is NesMapper for any cartridge, a concrete final mapper lets its
+// handlers be inlined
+template <class Cpu_t, class Ppu_t, class Controllers_t, class Apu_t, class Mapper_t = NesMapper>
+class CpuMemoryMap final : public MemoryMap {
 public:
     std::array<Byte, 0x0800> RAM;
     Cpu_t * CPU;
     Ppu_t * PPU;
-    NesMapper * Mapper;
+    Mapper_t * Mapper;
     Controllers_t * Controllers;
     Apu_t * APU;
     
-    CpuMemoryMap(Cpu_t * cpu, Apu_t * apu, Ppu_t * ppu, NesMapper * mapper, Controllers_t * controllers)
+    // RAM and the cartridge memory of the current banks, the I/O pages
+    // always go through the handlers below
+    PageTable Pages;
+
+    CpuMemoryMap(Cpu_t * cpu, Apu_t * apu, Ppu_t * ppu, Mapper_t * mapper, Controllers_t * controllers)
         : CPU(cpu), APU(apu), PPU(ppu), Mapper(mapper), Controllers(controllers)
-    {}
+    {
+        RAM.fill(0x00);
+        for (Word mirror = 0x0000; mirror < 0x2000; mirror += 0x0800) {
+            Pages.MapReadWrite(mirror, RAM.size(), RAM.data());
+        }
+    }
 
     ~CpuMemoryMap() override {}
 
+    // Maps the cartridge pages of the current banks, done again whenever a
+    // write to the cartridge switches PRG banks
+    void MapCartridge() {
+        Pages.Unmap(0x4400, 0x10000 - 0x4400);
+        if (Mapper != nullptr) Mapper->MapCpuPages(Pages);
+    }
+
+    const PageTable * DirectPages() const override {
+        return &Pages;
+    }
+
+    void SaveState(StateWriter & state) { state(RAM); }
+    void LoadState(StateReader & state) { state(RAM); }
+
     Byte GetByteAt(const Word address) const override {
+        const auto page = Pages.Read[PageTable::Page(address)];
+        if (page != nullptr) return page[address & PageTable::PAGE_MASK];
+
         if (address < 0x2000) {
             return RAM[address & 0x07FF];
         } else if (address < 0x4000) {
+            PPU->Sync();
             const auto addr = address & 0x2007;
             if (addr == 0x2002) return PPU->ReadStatus();
             if (addr == 0x2004) return PPU->ReadOAMData();
@@ -60,7 +97,10 @@ public:
         } else if (address < 0x4020) {
             if (address == 0x4016) return Controllers->ReadP1();
             if (address == 0x4017) return Controllers->ReadP2();
-            if (address == 0x4015) return APU->ReadStatus();
+            if (address == 0x4015) {
+                APU->Sync();
+                return APU->ReadStatus();
+            }
             return 0;
         } else {
             return Mapper->GetCpuAt(address);
@@ -68,61 +108,95 @@ public:
     }
 
     void SetByteAt(const Word address, const Byte value) override {
+        const auto page = Pages.Write[PageTable::Page(address)];
+        if (page != nullptr) {
+            page[address & PageTable::PAGE_MASK] = value;
+            return;
+        }
+
         if (address < 0x2000) {
             RAM[address & 0x07FF] = value;
         } else if (address < 0x4000) {
-            const auto addr = address & 0x2007;
-            if (addr == 0x2000) PPU->WriteControl1(value);
-            if (addr == 0x2001) PPU->WriteControl2(value);
-            if (addr == 0x2002) PPU->Bus.Write(value);
-            if (addr == 0x2003) PPU->WriteOAMAddress(value);
-            if (addr == 0x2004) PPU->WriteOAMData(value);
-            if (addr == 0x2005) PPU->WriteScroll(value);
-            if (addr == 0x2006) PPU->WriteAddress(value);
-            if (addr == 0x2007) PPU->WriteData(value);
+            PPU->Sync();
+            switch (address & 0x2007) {
+            case 0x2000: PPU->WriteControl1(value); break;
+            case 0x2001: PPU->WriteControl2(value); break;
+            case 0x2002: PPU->Bus.Write(value); break;
+            case 0x2003: PPU->WriteOAMAddress(value); break;
+            case 0x2004: PPU->WriteOAMData(value); break;
+            case 0x2005: PPU->WriteScroll(value); break;
+            case 0x2006: PPU->WriteAddress(value); break;
+            case 0x2007: PPU->WriteData(value); break;
+            }
         } else if (address < 0x4020) {
-            if (address == 0x4014) CPU->DMA(value, PPU->SprRam, PPU->OAMAddress);
-            if (address == 0x4016) Controllers->Write(value);
-            if (address == 0x4000) APU->WritePulse1Control(value);
-            if (address == 0x4001) APU->WritePulse1Sweep(value);
-            if (address == 0x4002) APU->WritePulse1PeriodLo(value);
-            if (address == 0x4003) APU->WritePulse1PeriodHi(value);
-            if (address == 0x4004) APU->WritePulse2Control(value);
-            if (address == 0x4005) APU->WritePulse2Sweep(value);
-            if (address == 0x4006) APU->WritePulse2PeriodLo(value);
-            if (address == 0x4007) APU->WritePulse2PeriodHi(value);
-            if (address == 0x4008) APU->WriteTriangleControl(value);
-            if (address == 0x400A) APU->WriteTrianglePeriodLo(value);
-            if (address == 0x400B) APU->WriteTrianglePeriodHi(value);
-            if (address == 0x400C) APU->WriteNoiseControl(value);
-            if (address == 0x400E) APU->WriteNoisePeriod(value);
-            if (address == 0x400F) APU->WriteNoiseLength(value);
-            if (address == 0x4010) APU->WriteDMCFrequency(value);
-            if (address == 0x4011) APU->WriteDMCDAC(value);
-            if (address == 0x4012) APU->WriteDMCAddress(value);
-            if (address == 0x4013) APU->WriteDMCLength(value);
-            if (address == 0x4015) APU->WriteCommonEnable(value);
-            if (address == 0x4017) APU->WriteCommonControl(value);
+            if (address == 0x4014) {
+                PPU->Sync();
+                CPU->DMA(value, PPU->SprRam, PPU->OAMAddress);
+                return;
+            }
+            if (address == 0x4016) {
+                Controllers->Write(value);
+                return;
+            }
+            APU->Sync();
+            switch (address) {
+            case 0x4000: APU->WritePulse1Control(value); break;
+            case 0x4001: APU->WritePulse1Sweep(value); break;
+            case 0x4002: APU->WritePulse1PeriodLo(value); break;
+            case 0x4003: APU->WritePulse1PeriodHi(value); break;
+            case 0x4004: APU->WritePulse2Control(value); break;
+            case 0x4005: APU->WritePulse2Sweep(value); break;
+            case 0x4006: APU->WritePulse2PeriodLo(value); break;
+            case 0x4007: APU->WritePulse2PeriodHi(value); break;
+            case 0x4008: APU->WriteTriangleControl(value); break;
+            case 0x400A: APU->WriteTrianglePeriodLo(value); break;
+            case 0x400B: APU->WriteTrianglePeriodHi(value); break;
+            case 0x400C: APU->WriteNoiseControl(value); break;
+            case 0x400E: APU->WriteNoisePeriod(value); break;
+            case 0x400F: APU->WriteNoiseLength(value); break;
+            case 0x4010: APU->WriteDMCFrequency(value); break;
+            case 0x4011: APU->WriteDMCDAC(value); break;
+            case 0x4012: APU->WriteDMCAddress(value); break;
+            case 0x4013: APU->WriteDMCLength(value); break;
+            case 0x4015: APU->WriteCommonEnable(value); break;
+            case 0x4017: APU->WriteCommonControl(value); break;
+            }
         } else {
+            // Bank and mirroring registers change what the PPU fetches,
+            // expansion sound registers what the APU mixes
+            PPU->Sync();
+            APU->Sync();
+            const auto generation = Mapper->PrgGeneration;
             Mapper->SetCpuAt(address, value);
+            if (Mapper->PrgGeneration != generation) MapCartridge();
         }
     }
+
+    const size_t * PrgGeneration() const override {
+        return (Mapper != nullptr) ? &Mapper->PrgGeneration : nullptr;
+    }
 };
 
-template <class Palette_t>
-class PpuMemoryMap : public MemoryMap {
+// Mapper_t as for CpuMemoryMap
+template <class Palette_t, class Mapper_t = NesMapper>
+class PpuMemoryMap final : public MemoryMap {
 public:
     //std::array<Byte, 0x0100> SprRam;
     std::array<Byte, 0x0800> Vram;
     Palette_t * PpuPalette;
-    NesMapper * Mapper;
+    Mapper_t * Mapper;
 
-    PpuMemoryMap(Palette_t * palette, NesMapper * mapper)
+    PpuMemoryMap(Palette_t * palette, Mapper_t * mapper)
         : PpuPalette(palette), Mapper(mapper)
-    {}
+    {
+        Vram.fill(0x00);
+    }
 
     ~PpuMemoryMap() override {}
 
+    void SaveState(StateWriter & state) { state(Vram); }
+    void LoadState(StateReader & state) { state(Vram); }
+
     Byte GetByteAt(const Word address) const override {
         if (address >= 0x3F00) {
             return PpuPalette->ReadAt(address - 0x3F00);
@@ -132,6 +206,9 @@ public:
             return Vram[addr];
         }
         else {
+            MapPatterns();
+            const auto page = Patterns.Read[PageTable::Page(address)];
+            if (page != nullptr) return page[address & PageTable::PAGE_MASK];
             return Mapper->GetPpuAt(address);
         }
     }
@@ -145,9 +222,28 @@ public:
             Vram[addr] = value;
         }
         else {
+            MapPatterns();
+            const auto page = Patterns.Write[PageTable::Page(address)];
+            if (page != nullptr) {
+                page[address & PageTable::PAGE_MASK] = value;
+                return;
+            }
             return Mapper->SetPpuAt(address, value);
         }
     }
+
+private:
+    // Pattern table pages of the current CHR banks, a cache mapped again on
+    // the first access after the mapper switches banks
+    mutable PageTable Patterns;
+    mutable size_t patternGeneration = ~size_t(0);
+
+    void MapPatterns() const {
+        if (patternGeneration == Mapper->ChrGeneration) return;
+        Patterns.Unmap(0x0000, 0x2000);
+        Mapper->MapPpuPages(Patterns);
+        patternGeneration = Mapper->ChrGeneration;
+    }
 };
 
 #endif // MEMORY_MAP_H_
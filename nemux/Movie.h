@@ -0,0 +1,383 @@
+/*
+ * Movie.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: scorder
+ */
+
+#ifndef MOVIE_H_
+#define MOVIE_H_
+
+#include "Types.h"
+#include "Error.h"
+#include "Hash.h"
+#include "Replay.h"
+
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Binary input movies, all integers little endian
+//
+// Header
+//     "NMXM", u16 version, u16 flags, u16 iNES mapper, ROM SHA-1 (20 bytes),
+//     u16 length and bytes of the ROM path relative to the movie
+// Records, each applies when a frame has been emulated
+//     Input   0x01, u8 P1 state, varint frames: the next frames end with
+//             this input and nothing else
+//     Check   0x81, u64 picture hash, with the FrameDumps flag a varint
+//             length and the PackBits packed picture, the low bytes of
+//             all pixels then the high bytes
+// Picture hashes chain the XXH64 of each line, seeded with the hash of the
+// line above, version 1 movies hash all pixels with FNV-1a
+//     Reset   0x40
+//     End     0x00
+// A frame with a check or a reset writes them before its input
+namespace movie {
+    static constexpr Word VERSION = 2;
+
+    enum Flags : Word {
+        FrameDumps = 0x0001,
+    };
+
+    enum Records : Byte {
+        Input = 0x01,
+        Check = 0x81,
+        Reset = 0x40,
+        End = 0x00,
+    };
+
+    struct Header {
+        Word Version = VERSION;
+        Word Flags = 0;
+        Word Mapper = 0;
+        Sha1::Digest RomSha1 = {{}};
+        std::string RomPath;
+    };
+
+    // Visible 256x240 pixels of a frame, pixel x of a line is output on
+    // dot x + 1
+    typedef std::vector<Word> Picture;
+
+    template <class Frame_t>
+    Picture PictureOf(const Frame_t & frame) {
+        Picture picture(FRAME_WIDTH * FRAME_HEIGHT);
+        for (size_t y = 0; y < FRAME_HEIGHT; ++y) {
+            for (size_t x = 0; x < FRAME_WIDTH; ++x) {
+                picture[y * FRAME_WIDTH + x] = frame[y * VIDEO_WIDTH + x + replay::PIXEL_DOT_OFFSET];
+            }
+        }
+        return picture;
+    }
+
+    inline Picture PictureOf(const replay::FrameDump & dump) {
+        Picture picture(FRAME_WIDTH * FRAME_HEIGHT);
+        for (size_t y = 0; y < FRAME_HEIGHT; ++y) {
+            for (size_t x = 0; x < FRAME_WIDTH; ++x) {
+                picture[y * FRAME_WIDTH + x] = dump[y * VIDEO_WIDTH + x];
+            }
+        }
+        return picture;
+    }
+
+    inline Picture PictureOf(const IndexedFrame & frame) {
+        Picture picture(FRAME_WIDTH * FRAME_HEIGHT);
+        for (size_t y = 0; y < FRAME_HEIGHT; ++y) frame.Line(y, picture.data() + y * FRAME_WIDTH);
+        return picture;
+    }
+
+    // Hash of FRAME_HEIGHT lines of FRAME_WIDTH pixels, stride apart
+    inline uint64_t HashOf(const Word * pixels, const size_t stride) {
+        uint64_t hash = 0;
+        for (size_t y = 0; y < FRAME_HEIGHT; ++y) hash = Xxh64::Of(pixels + y * stride, FRAME_WIDTH * sizeof(Word), hash);
+        return hash;
+    }
+
+    inline uint64_t HashOf(const Picture & picture, const Word version = VERSION) {
+        if (version < 2) {
+            Fnv1a hash;
+            hash.Add(picture.data(), picture.size());
+            return hash.Value;
+        }
+        return HashOf(picture.data(), FRAME_WIDTH);
+    }
+
+    // Straight from the PPU frame, without copying the picture out
+    inline uint64_t HashOf(const std::array<Word, VIDEO_SIZE> & frame, const Word version = VERSION) {
+        if (version < 2) return HashOf(PictureOf(frame), version);
+        return HashOf(frame.data() + replay::PIXEL_DOT_OFFSET, VIDEO_WIDTH);
+    }
+
+    // From the PPU screen a line at a time
+    inline uint64_t HashOf(const IndexedFrame & frame, const Word version = VERSION) {
+        if (version < 2) return HashOf(PictureOf(frame), version);
+        std::array<Word, FRAME_WIDTH> line;
+        uint64_t hash = 0;
+        for (size_t y = 0; y < FRAME_HEIGHT; ++y) {
+            frame.Line(y, line.data());
+            hash = Xxh64::Of(line, hash);
+        }
+        return hash;
+    }
+
+    // Expected picture at a check, Pixels is only kept with frame dumps
+    struct Checkpoint {
+        uint64_t Hash = 0;
+        Picture Pixels;
+        // Movie version the hash was computed for
+        Word Version = VERSION;
+
+        bool Matches(const Picture & picture) const { return HashOf(picture, Version) == Hash; }
+        bool Matches(const std::array<Word, VIDEO_SIZE> & frame) const { return HashOf(frame, Version) == Hash; }
+        bool Matches(const IndexedFrame & frame) const { return HashOf(frame, Version) == Hash; }
+    };
+
+    inline Checkpoint CheckpointOf(const Picture & picture) {
+        Checkpoint checkpoint;
+        checkpoint.Hash = HashOf(picture);
+        checkpoint.Pixels = picture;
+        return checkpoint;
+    }
+
+    // PackBits: n < 128 is followed by n + 1 literal bytes, n > 128 by one
+    // byte repeated 257 - n times
+    inline std::vector<Byte> Pack(const std::vector<Byte> & data) {
+        std::vector<Byte> packed;
+        size_t i = 0;
+        while (i < data.size()) {
+            size_t run = 1;
+            while (i + run < data.size() && run < 128 && data[i + run] == data[i]) ++run;
+            if (run > 1) {
+                packed.push_back(Byte(257 - run));
+                packed.push_back(data[i]);
+                i += run;
+                continue;
+            }
+            size_t literal = 1;
+            while (i + literal < data.size() && literal < 128
+                && !(i + literal + 1 < data.size() && data[i + literal] == data[i + literal + 1])) ++literal;
+            packed.push_back(Byte(literal - 1));
+            packed.insert(packed.end(), data.begin() + i, data.begin() + i + literal);
+            i += literal;
+        }
+        return packed;
+    }
+
+    inline std::vector<Byte> Unpack(const std::vector<Byte> & packed) {
+        std::vector<Byte> data;
+        size_t i = 0;
+        while (i < packed.size()) {
+            const auto n = packed[i++];
+            if (n < 128) {
+                if (i + n + 1 > packed.size()) throw invalid_format("Truncated frame dump");
+                data.insert(data.end(), packed.begin() + i, packed.begin() + i + n + 1);
+                i += n + 1;
+            } else if (n > 128) {
+                if (i >= packed.size()) throw invalid_format("Truncated frame dump");
+                data.insert(data.end(), 257 - n, packed[i++]);
+            }
+        }
+        return data;
+    }
+
+    inline void WriteBytes(std::ostream & out, const uint64_t value, const size_t count) {
+        for (size_t i = 0; i < count; ++i) out.put(char(Byte(value >> (8 * i))));
+    }
+
+    inline uint64_t ReadBytes(std::istream & in, const size_t count) {
+        uint64_t value = 0;
+        for (size_t i = 0; i < count; ++i) {
+            const auto c = in.get();
+            if (c == std::char_traits<char>::eof()) throw invalid_format("Truncated movie");
+            value |= uint64_t(Byte(c)) << (8 * i);
+        }
+        return value;
+    }
+
+    inline void WriteVarint(std::ostream & out, uint64_t value) {
+        while (value >= 0x80) {
+            out.put(char(Byte(value | 0x80)));
+            value >>= 7;
+        }
+        out.put(char(Byte(value)));
+    }
+
+    inline uint64_t ReadVarint(std::istream & in) {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            const auto b = ReadBytes(in, 1);
+            value |= (b & 0x7F) << shift;
+            if ((b & 0x80) == 0) return value;
+        }
+        throw invalid_format("Malformed movie");
+    }
+
+    inline bool IsMovie(std::istream & in) {
+        char magic[4] = {};
+        const auto start = in.tellg();
+        in.read(magic, sizeof(magic));
+        const bool isMovie = in.gcount() == 4 && std::string(magic, 4) == "NMXM";
+        in.clear();
+        in.seekg(start);
+        return isMovie;
+    }
+
+    // Records a movie one frame at a time, identical inputs are merged
+    class Writer {
+    public:
+        Writer(std::ostream & out, const Header & header) : out(out), flags(header.Flags) {
+            out.write("NMXM", 4);
+            WriteBytes(out, header.Version, 2);
+            WriteBytes(out, header.Flags, 2);
+            WriteBytes(out, header.Mapper, 2);
+            out.write(reinterpret_cast<const char *>(header.RomSha1.data()), header.RomSha1.size());
+            WriteBytes(out, header.RomPath.size(), 2);
+            out.write(header.RomPath.data(), header.RomPath.size());
+        }
+        Writer(const Writer &) = delete;
+        Writer & operator=(const Writer &) = delete;
+        ~Writer() { Close(); }
+
+        // Called once an emulated frame is over, check is nullptr or what
+        // the frame must show, reset and p1 apply before the next frame
+        void EndFrame(const Byte p1, const Checkpoint * check = nullptr, const bool reset = false) {
+            if (check) {
+                Flush();
+                out.put(char(Check));
+                WriteBytes(out, check->Hash, 8);
+                if (flags & FrameDumps) {
+                    if (check->Pixels.size() != FRAME_WIDTH * FRAME_HEIGHT) throw invalid_format("Check without picture");
+                    // Low bytes then high bytes so runs of pixels pack
+                    const auto size = check->Pixels.size();
+                    std::vector<Byte> bytes(2 * size);
+                    for (size_t i = 0; i < size; ++i) {
+                        bytes[i] = LO(check->Pixels[i]);
+                        bytes[size + i] = HI(check->Pixels[i]);
+                    }
+                    const auto packed = Pack(bytes);
+                    WriteVarint(out, packed.size());
+                    out.write(reinterpret_cast<const char *>(packed.data()), packed.size());
+                }
+            }
+            if (reset) {
+                Flush();
+                out.put(char(Reset));
+            }
+            if (frames > 0 && p1 != input) Flush();
+            input = p1;
+            ++frames;
+        }
+
+        void Close() {
+            if (closed) return;
+            Flush();
+            out.put(char(End));
+            out.flush();
+            closed = true;
+        }
+
+    private:
+        std::ostream & out;
+        const Word flags;
+        Byte input = 0;
+        uint64_t frames = 0;
+        bool closed = false;
+
+        void Flush() {
+            if (frames == 0) return;
+            out.put(char(Input));
+            out.put(char(input));
+            WriteVarint(out, frames);
+            frames = 0;
+        }
+    };
+
+    // Plays movies of this format, or the legacy replays of Replay.h
+    class Player {
+    public:
+        explicit Player(std::istream & in) : in(in), IsLegacy(!IsMovie(in)) {
+            if (IsLegacy) {
+                MovieHeader.Version = 0;
+                MovieHeader.RomPath = replay::ReadRomPath(in);
+                return;
+            }
+            ReadBytes(in, 4);
+            MovieHeader.Version = Word(ReadBytes(in, 2));
+            if (MovieHeader.Version > VERSION) throw unsupported_format("Unsupported movie version");
+            MovieHeader.Flags = Word(ReadBytes(in, 2));
+            MovieHeader.Mapper = Word(ReadBytes(in, 2));
+            for (auto & b : MovieHeader.RomSha1) b = Byte(ReadBytes(in, 1));
+            MovieHeader.RomPath.resize(size_t(ReadBytes(in, 2)));
+            in.read(&MovieHeader.RomPath[0], MovieHeader.RomPath.size());
+        }
+
+        std::istream & in;
+        const bool IsLegacy;
+        Header MovieHeader;
+
+        // Applies the records of the frame just emulated and hands checks to
+        // check(const Checkpoint &), returns false once the movie is over
+        template <class Console_t, class Check_t>
+        bool PlayFrame(Console_t & nes, Check_t check) {
+            if (IsLegacy) {
+                return replay::PlayFrame(in, nes, [&check](const replay::FrameDump & dump) {
+                    check(CheckpointOf(PictureOf(dump)));
+                });
+            }
+            if (remaining > 0) {
+                --remaining;
+                return true;
+            }
+            for (;;) {
+                const auto record = in.get();
+                if (record == std::char_traits<char>::eof()) return false;
+                switch (Byte(record)) {
+                case End: return false;
+                case Input: {
+                    replay::SetP1State(nes.ctrl, Byte(ReadBytes(in, 1)));
+                    const auto frames = ReadVarint(in);
+                    if (frames == 0) throw invalid_format("Malformed movie");
+                    remaining = frames - 1;
+                    return true;
+                }
+                case Check: {
+                    Checkpoint checkpoint;
+                    checkpoint.Hash = ReadBytes(in, 8);
+                    checkpoint.Version = MovieHeader.Version;
+                    if (MovieHeader.Flags & FrameDumps) {
+                        std::vector<Byte> packed(size_t(ReadVarint(in)));
+                        in.read(reinterpret_cast<char *>(packed.data()), packed.size());
+                        const auto bytes = Unpack(packed);
+                        if (bytes.size() != 2 * FRAME_WIDTH * FRAME_HEIGHT) throw invalid_format("Malformed frame dump");
+                        const auto size = FRAME_WIDTH * FRAME_HEIGHT;
+                        checkpoint.Pixels.resize(size);
+                        for (size_t i = 0; i < size; ++i) {
+                            checkpoint.Pixels[i] = Word(bytes[i] | (bytes[size + i] << 8));
+                        }
+                    }
+                    check(checkpoint);
+                    break;
+                }
+                case Reset: {
+                    nes.Reset();
+                    break;
+                }
+                default: throw invalid_format("Malformed movie");
+                }
+            }
+        }
+
+        template <class Console_t>
+        bool PlayFrame(Console_t & nes) {
+            return PlayFrame(nes, [](const Checkpoint &) {});
+        }
+
+    private:
+        uint64_t remaining = 0;
+    };
+}
+
+#endif /* MOVIE_H_ */
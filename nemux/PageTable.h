@@ -0,0 +1,59 @@
+/*
+ * PageTable.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: scorder
+ */
+
+#ifndef PAGE_TABLE_H_
+#define PAGE_TABLE_H_
+
+#include "Types.h"
+
+#include <array>
+#include <cstddef>
+
+// Direct pointers to the memory behind each 1 KiB page of the CPU address
+// space (or of the PPU pattern tables), nullptr when accesses to the page
+// have side effects and must go through the memory map handlers
+struct PageTable {
+    static constexpr size_t PAGE_BITS = 10;
+    static constexpr size_t PAGE_SIZE = size_t(1) << PAGE_BITS;
+    static constexpr size_t PAGE_MASK = PAGE_SIZE - 1;
+    static constexpr size_t PAGES = 0x10000 >> PAGE_BITS;
+
+    std::array<const Byte *, PAGES> Read;
+    std::array<Byte *, PAGES> Write;
+
+    PageTable() {
+        Read.fill(nullptr);
+        Write.fill(nullptr);
+    }
+
+    static size_t Page(const Word address) {
+        return address >> PAGE_BITS;
+    }
+
+    // Maps size bytes at address, both multiples of the page size
+    void MapRead(const Word address, const size_t size, const Byte * data) {
+        for (size_t offset = 0; offset < size; offset += PAGE_SIZE) {
+            Read[Page(Word(address + offset))] = data + offset;
+        }
+    }
+
+    void MapReadWrite(const Word address, const size_t size, Byte * data) {
+        for (size_t offset = 0; offset < size; offset += PAGE_SIZE) {
+            Read[Page(Word(address + offset))] = data + offset;
+            Write[Page(Word(address + offset))] = data + offset;
+        }
+    }
+
+    void Unmap(const Word address, const size_t size) {
+        for (size_t offset = 0; offset < size; offset += PAGE_SIZE) {
+            Read[Page(Word(address + offset))] = nullptr;
+            Write[Page(Word(address + offset))] = nullptr;
+        }
+    }
+};
+
+#endif /* PAGE_TABLE_H_ */
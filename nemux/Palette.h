@@ -22,7 +22,7 @@ public:
         return Data[Mirror(Address)] & 0x3F;
     }
 
-    std::array<Byte, 0x20> Data;
+    std::array<Byte, 0x20> Data = {{}};
 };
 
 #endif // PALETTE_H_
@@ -12,12 +12,16 @@
 #include "BitUtil.h"
 #include "Palette.h"
 #include "MemoryMap.h"
+#include "State.h"
 
 #include "Ricoh_RP2C02.h"
 
+#include <algorithm>
 #include <array>
 #include <iostream>
 #include <iomanip>
+#include <tuple>
+#include <vector>
 
 static constexpr size_t FRAME_WIDTH = 256;
 static constexpr size_t FRAME_HEIGHT = 240;
@@ -25,16 +29,69 @@ static constexpr size_t VIDEO_WIDTH = 341;
 static constexpr size_t VIDEO_HEIGHT = 262;
 static constexpr size_t VIDEO_SIZE = VIDEO_WIDTH * VIDEO_HEIGHT;
 
+// Pixel x of a visible scanline is output on dot x + 1
+static constexpr size_t FRAME_DOT_OFFSET = 1;
+
+// Visible pixels of a frame as palette indices, the greyscale and emphasis
+// bits of the Frame entries (bits 6-9) are kept in Modes from the pixel they
+// change on, usually once per frame
+struct IndexedFrame {
+    struct Mode {
+        Word Pixel;
+        Word Bits;
+    };
+
+    // FRAME_WIDTH * FRAME_HEIGHT, a vector so that frames are handed over
+    // by swapping, see FrameExchange
+    std::vector<Byte> Pixels;
+    // By pixel, the first one on pixel 0
+    std::vector<Mode> Modes;
+
+    IndexedFrame() : Pixels(FRAME_WIDTH * FRAME_HEIGHT, 0x00), Modes(1, Mode{ 0, 0 }) {}
+
+    // Pixels from pixel on are drawn with bits, the modes of the pixels
+    // drawn again are dropped
+    void SetMode(const size_t pixel, const Word bits) {
+        while (!Modes.empty() && (Modes.back().Pixel >= pixel)) Modes.pop_back();
+        if (Modes.empty() || (Modes.back().Bits != bits)) Modes.push_back({ Word(pixel), bits });
+    }
+
+    // Frame entries of the pixels of line y
+    void Line(const size_t y, Word * line) const {
+        const size_t first = y * FRAME_WIDTH;
+        auto mode = std::upper_bound(Modes.begin(), Modes.end(), first,
+            [](const size_t pixel, const Mode & m) { return pixel < m.Pixel; }) - 1;
+        for (size_t x = 0; x < FRAME_WIDTH; ++x) {
+            const auto next = mode + 1;
+            if ((next != Modes.end()) && (next->Pixel == first + x)) mode = next;
+            line[x] = mode->Bits | Pixels[first + x];
+        }
+    }
+
+    bool operator==(const IndexedFrame & other) const {
+        std::array<Word, FRAME_WIDTH> line, otherLine;
+        for (size_t y = 0; y < FRAME_HEIGHT; ++y) {
+            Line(y, line.data());
+            other.Line(y, otherLine.data());
+            if (line != otherLine) return false;
+        }
+        return true;
+    }
+    bool operator!=(const IndexedFrame & other) const { return !(*this == other); }
+};
+
 static const bool USE_RP2C02 = true;
 
+// Map_t is the PPU bus, see Ricoh_RP2C02
+template <class Map_t = MemoryMap>
 class Ppu {
 public:
     class PpuBus {
-        size_t Ticks0_4;
-        size_t Ticks5_7;
-        Byte content;
+        size_t Ticks0_4 = 0;
+        size_t Ticks5_7 = 0;
+        Byte content = 0;
     public:
-        size_t Ticks;
+        size_t Ticks = 0;
         void WriteLo(const Byte value) {
             content = (content & 0xE0) | (value & 0x1F);
             Ticks0_4 = Ticks;
@@ -61,6 +118,11 @@ public:
             if ((Ticks - Ticks5_7) < size_t{ 2700000 }) return (content & 0xC0);
             return 0;
         }
+
+        template <class State_t>
+        void Serialize(State_t & state) {
+            state(Ticks0_4, Ticks5_7, content, Ticks);
+        }
     } Bus;
 
     void WriteControl1(Byte value) {
@@ -222,6 +284,56 @@ public:
         return hit;
     }
 
+    static constexpr size_t VBL_START = 241 * 341 + 1;
+    static constexpr size_t VBL_STOP = 261 * 341 + 1;
+
+    // Catch-up scheduling
+    // Dots are owed until something can observe them: a register or
+    // cartridge access from the CPU (Sync), the next VBlank edge which moves
+    // the NMI line, or the end of the frame
+    // No access lands among owed dots, so they run a tile span at a time
+    // where they can and dot by dot elsewhere
+    size_t PendingDots = 0;
+    size_t DeadlineDots = 0;
+
+    static constexpr size_t TILE_DOTS = Ricoh_RP2C02<Map_t>::TILE_DOTS;
+
+    void Schedule(const size_t dots) {
+        PendingDots += dots;
+        if (PendingDots >= DeadlineDots) CatchUp();
+    }
+
+    void CatchUp() {
+        while (PendingDots > 0) {
+            if (USE_RP2C02 && (PendingDots >= TILE_DOTS) && rp2c02.AtTileSpan()) {
+                PendingDots -= TILE_DOTS;
+                TickTile();
+            }
+            else {
+                --PendingDots;
+                Tick();
+            }
+        }
+        DeadlineDots = DotsToNextEvent();
+    }
+
+    // The access may move the NMI line within the next few dots so the next
+    // scheduled dots are run right away
+    void Sync() {
+        CatchUp();
+        DeadlineDots = 0;
+    }
+
+    // The NMI line follows VBlank a couple of dots late, around both edges
+    // and at the end of the frame the PPU keeps in step with the CPU
+    size_t DotsToNextEvent() const {
+        static constexpr size_t WINDOW = 6;
+        size_t next = VIDEO_SIZE - WINDOW;
+        if (FrameTicks <= VBL_STOP + WINDOW) next = VBL_STOP - WINDOW;
+        if (FrameTicks <= VBL_START + WINDOW) next = VBL_START - WINDOW;
+        return (FrameTicks < next) ? (next - FrameTicks) : 0;
+    }
+
     std::vector<std::tuple<int, std::array<Byte, 4>>> sprites;
     void Tick() {
         ++Bus.Ticks;
@@ -243,10 +355,14 @@ public:
 
         if (USE_RP2C02) {
             const auto ci = rp2c02.pixel;
-            Frame[VIDEO_WIDTH * y + x] =
-                ((IsColour ? 0 : 1) << 9)
-                | (ColourIntensity << 6)
-                | PpuPalette.ReadAt(ci);
+            const auto mode = Mode();
+            const auto colour = PpuPalette.ReadAt(ci);
+            if (FullFrame) Frame[VIDEO_WIDTH * y + x] = mode | colour;
+            if ((y < FRAME_HEIGHT) && (x - FRAME_DOT_OFFSET < FRAME_WIDTH)) {
+                const auto pixel = FRAME_WIDTH * y + x - FRAME_DOT_OFFSET;
+                Screen.SetMode(pixel, mode);
+                Screen.Pixels[pixel] = colour;
+            }
         }
         else if ((y < FRAME_HEIGHT) && (x < FRAME_WIDTH)) {
             auto bg = 0;
@@ -339,12 +455,8 @@ public:
         //// NMI is deactivated after the last tick of scanline 260 (i.e. on (0, 261) (?))
         //if ((y == 261) && (x == 0))
         //    NMIActive = false;
-        static constexpr size_t VBL_START = 241 * 341 + 1;
-        static constexpr size_t VBL_STOP = 261 * 341 + 1;
-        
+
         // VBlank buffers to account for delay in CPU detection
-        static bool vblDelayed1 = false;
-        static bool vblDelayed2 = false;
         vblDelayed2 = vblDelayed1;
         vblDelayed1 = VBlank;
 
@@ -384,12 +496,45 @@ public:
         }
     }
 
+    // TILE_DOTS calls to Tick on an active scanline, where VBlank holds and
+    // the frame does not end
+    void TickTile() {
+        Bus.Ticks += TILE_DOTS;
+
+        rp2c02.Map = Map;
+        rp2c02.pOAM = &SprRam;
+        const auto first = rp2c02.Ticks;
+        std::array<Byte, TILE_DOTS> pixels;
+        rp2c02.TickTile(pixels.data());
+        SpriteZeroHit = rp2c02.SpriteZeroHit;
+
+        const auto mode = Mode();
+        const auto pixel = FRAME_WIDTH * (first / VIDEO_WIDTH) + (first % VIDEO_WIDTH) - FRAME_DOT_OFFSET;
+        Screen.SetMode(pixel, mode);
+        Byte * colours = &Screen.Pixels[pixel];
+        for (size_t i = 0; i < TILE_DOTS; ++i) colours[i] = PpuPalette.ReadAt(pixels[i]);
+        if (FullFrame) {
+            for (size_t i = 0; i < TILE_DOTS; ++i) Frame[first + i] = mode | colours[i];
+        }
+
+        vblDelayed2 = vblDelayed1 = VBlank;
+        NMIActive = (NMIOnVBlank && vblDelayed2);
+        FrameTicks = rp2c02.Ticks;
+        FrameCount = rp2c02.Frame;
+    }
+
+    // Greyscale and emphasis bits of the pixels output now
+    Word Mode() const {
+        return Word(((IsColour ? 0 : 1) << 9) | (ColourIntensity << 6));
+    }
+
     std::array<Byte, 89342> FrameBuffer;
     void Render() {
         FrameBuffer.fill(0);
     }
 
-    explicit Ppu(MemoryMap * map = nullptr) {
+    explicit Ppu(Map_t * map = nullptr) {
+        SprRam.fill(0x00);
         OAMAddress = 0x00;
 
         //IgnoreVramWrites;
@@ -429,6 +574,8 @@ public:
         Frame.fill(0x00);
 
         StatusReadOn = 0;
+        vblDelayed1 = false;
+        vblDelayed2 = false;
     }
 
     struct {
@@ -466,7 +613,7 @@ public:
 
     Word Address;
 
-    MemoryMap * Map;
+    Map_t * Map;
 
     Byte ReadDataBuffer;
 
@@ -478,11 +625,36 @@ public:
 
     size_t FrameTicks;
     size_t FrameCount;
+    // Every dot, blanking included, with the greyscale and emphasis bits of
+    // each, only output with FullFrame set
     std::array<Word, VIDEO_SIZE> Frame;
+    bool FullFrame = false;
+    IndexedFrame Screen;
 
     size_t StatusReadOn;
 
-    Ricoh_RP2C02 rp2c02;
+    Ricoh_RP2C02<Map_t> rp2c02;
+
+    // Registers, OAM, palette and the dot being drawn; the pixels already
+    // output to Frame and Screen are not part of the state
+    template <class State_t>
+    void Serialize(State_t & state) {
+        Bus.Serialize(state);
+        state(Latch.Status, SprRam, OAMAddress, SpriteOverflow, SpriteZeroHit, VBlank,
+            IsColour, ClipBackground, ClipSprite, ShowBackground, ShowSprite, ColourIntensity,
+            SpriteHeight, NameTable, SpriteTable, BackgroundTable, AddressIncrement, NMIOnVBlank,
+            ScrollX, ScrollY, Address, ReadDataBuffer, PpuPalette.Data,
+            NMIActive, Ticks, Frames, FrameTicks, FrameCount, StatusReadOn,
+            vblDelayed1, vblDelayed2, PendingDots, DeadlineDots);
+        rp2c02.Serialize(state);
+    }
+
+    void SaveState(StateWriter & state) { Serialize(state); }
+    void LoadState(StateReader & state) { Serialize(state); }
+
+private:
+    bool vblDelayed1;
+    bool vblDelayed2;
 };
 
 #endif /* PPU_H_ */
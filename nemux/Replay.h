@@ -0,0 +1,114 @@
+/*
+ * Replay.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: scorder
+ */
+
+#ifndef REPLAY_H_
+#define REPLAY_H_
+
+#include "Types.h"
+#include "BitUtil.h"
+#include "Controllers.h"
+#include "Ppu.h"
+
+#include <istream>
+#include <string>
+#include <vector>
+
+// Input movies recorded by nemux-vis -record
+// The ROM path ends with '\0', then one block per emulated frame:
+// FrameStart, any commands, FrameEnd
+namespace replay {
+    enum Commands : char {
+        FrameStart = 0x0F,
+        Player_1 = 0x01,
+        CheckFrame = char(0x81),
+        FrameEnd = 0x00,
+        Reset = 0x40,
+    };
+    inline Byte GetP1State(const Controllers & ctrl) {
+        return Mask<0>(ctrl.P1_A)
+             | Mask<1>(ctrl.P1_B)
+             | Mask<2>(ctrl.P1_Select)
+             | Mask<3>(ctrl.P1_Start)
+             | Mask<4>(ctrl.P1_Up)
+             | Mask<5>(ctrl.P1_Down)
+             | Mask<6>(ctrl.P1_Left)
+             | Mask<7>(ctrl.P1_Right);
+    }
+    inline void SetP1State(Controllers & ctrl, Byte p1) {
+        ctrl.P1_A      = IsBitSet<0>(p1);
+        ctrl.P1_B      = IsBitSet<1>(p1);
+        ctrl.P1_Select = IsBitSet<2>(p1);
+        ctrl.P1_Start  = IsBitSet<3>(p1);
+        ctrl.P1_Up     = IsBitSet<4>(p1);
+        ctrl.P1_Down   = IsBitSet<5>(p1);
+        ctrl.P1_Left   = IsBitSet<6>(p1);
+        ctrl.P1_Right  = IsBitSet<7>(p1);
+    }
+
+    inline std::string ReadRomPath(std::istream & movie) {
+        std::string path;
+        std::getline(movie, path, '\0');
+        return path;
+    }
+
+    // CheckFrame payload, one palette index per dot of the frame, only the
+    // visible pixels are meaningful
+    typedef std::vector<Byte> FrameDump;
+
+    // Pixel x of a scanline is output on dot x + 1, dumps store it at x
+    static constexpr size_t PIXEL_DOT_OFFSET = FRAME_DOT_OFFSET;
+
+    // Returns the first visible pixel, as a dump index, that differs between
+    // the console frame and the dump, VIDEO_SIZE if they match
+    template <class Frame_t>
+    size_t FirstMismatch(const Frame_t & frame, const FrameDump & dump) {
+        for (size_t y = 0; y < FRAME_HEIGHT; ++y) {
+            for (size_t x = 0; x < FRAME_WIDTH; ++x) {
+                const auto i = y * VIDEO_WIDTH + x;
+                if (frame[i + PIXEL_DOT_OFFSET] != dump[i]) return i;
+            }
+        }
+        return VIDEO_SIZE;
+    }
+
+    // Applies the next frame block to the console and hands CheckFrame
+    // dumps to check(const FrameDump &), returns false once the movie is over
+    // Commands are raw bytes, the movie must be opened in binary mode
+    template <class Console_t, class Check_t>
+    bool PlayFrame(std::istream & movie, Console_t & nes, Check_t check) {
+        if (movie.get() == std::char_traits<char>::eof()) return false;
+        for (;;) {
+            const auto cmd = movie.get();
+            if (cmd == std::char_traits<char>::eof()) return false;
+            switch (char(cmd)) {
+            case FrameEnd: return true;
+            case Player_1: {
+                SetP1State(nes.ctrl, Byte(movie.get()));
+                break;
+            }
+            case CheckFrame: {
+                FrameDump dump(VIDEO_SIZE);
+                movie.read(reinterpret_cast<char *>(dump.data()), dump.size());
+                if (movie.gcount() != std::streamsize(dump.size())) return false;
+                check(dump);
+                break;
+            }
+            case Reset: {
+                nes.Reset();
+                break;
+            }
+            }
+        }
+    }
+
+    template <class Console_t>
+    bool PlayFrame(std::istream & movie, Console_t & nes) {
+        return PlayFrame(movie, nes, [](const FrameDump &) {});
+    }
+}
+
+#endif /* REPLAY_H_ */
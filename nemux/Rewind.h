@@ -0,0 +1,224 @@
+/*
+ * Rewind.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: scorder
+ */
+
+#ifndef REWIND_H_
+#define REWIND_H_
+
+#include "Types.h"
+#include "Replay.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+// Recent history of a console, to step back frame by frame
+// A save state is taken every Interval frames. The newest one is kept whole
+// and each older one is stored as its XOR with the next newer state, packed
+// in a ring of Capacity bytes after the inputs of the frames it starts.
+// The oldest states are dropped when the ring is full.
+//
+// Packed delta: varint size of the older state, then until the end of the
+// longer state: varint count of zero bytes, varint count of literal bytes
+// and the literal bytes
+class Rewind {
+public:
+    Rewind(const size_t capacity, const size_t interval)
+        : Capacity(capacity), Interval(std::max<size_t>(interval, 1)), ring(capacity)
+    {}
+
+    const size_t Capacity;
+    const size_t Interval;
+
+    // Packed size of the last stored state, for statistics
+    size_t LastDeltaSize = 0;
+
+    // Frames recorded, the console has emulated them once Record returns
+    // and the frame has run
+    uint64_t Frames() const { return headFrame + inputs.size(); }
+
+    // Earliest frame Seek can bring the console to
+    uint64_t OldestFrame() const {
+        if (head.empty()) return 0;
+        return entries.empty() ? headFrame : entries.front().Frame;
+    }
+
+    // Bytes of the ring holding older states, plus the newest state
+    size_t BytesUsed() const { return used + head.size() + inputs.size(); }
+
+    // Called before each frame is emulated, once its input is set
+    template <class Console_t>
+    void Record(Console_t & nes) {
+        if (head.empty()) {
+            nes.SaveState(head);
+            headFrame = Frames();
+        }
+        else if (inputs.size() == Interval) {
+            nes.SaveState(state);
+            Store();
+            head.swap(state);
+            headFrame += inputs.size();
+            inputs.clear();
+        }
+        inputs.push_back(replay::GetP1State(nes.ctrl));
+    }
+
+    // Brings the console to the end of a recorded frame: loads the closest
+    // older state and emulates the frames after it again with their inputs
+    // Later frames are forgotten, false if the frame is out of the history
+    template <class Console_t>
+    bool Seek(Console_t & nes, const uint64_t frame) {
+        if ((frame < OldestFrame()) || (frame > Frames())) return false;
+        if (frame == Frames()) return true;
+
+        while (headFrame > frame) {
+            const auto entry = entries.back();
+            entries.pop_back();
+            const Byte * blob = &ring[entry.Offset];
+            inputs.assign(blob, blob + Interval);
+            Unpack(blob + Interval, head);
+            headFrame = entry.Frame;
+            writePos = entry.Offset;
+            used -= entry.Size;
+        }
+
+        nes.LoadState(head);
+        inputs.resize(size_t(frame - headFrame));
+        for (const auto input : inputs) {
+            replay::SetP1State(nes.ctrl, input);
+            nes.RunUntilFrame();
+        }
+        return true;
+    }
+
+    template <class Console_t>
+    bool StepBack(Console_t & nes) {
+        return (Frames() > 0) && Seek(nes, Frames() - 1);
+    }
+
+private:
+    struct Entry {
+        uint64_t Frame;
+        size_t Offset;
+        size_t Size;
+    };
+
+    std::vector<Byte> head;
+    uint64_t headFrame = 0;
+    std::vector<Byte> inputs;
+
+    std::vector<Byte> ring;
+    std::deque<Entry> entries;
+    size_t writePos = 0;
+    size_t used = 0;
+
+    // Reused to avoid allocations while recording
+    std::vector<Byte> state;
+    std::vector<Byte> delta;
+    std::vector<Byte> packed;
+
+    static void WriteVarint(std::vector<Byte> & out, size_t value) {
+        while (value >= 0x80) {
+            out.push_back(Byte(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(Byte(value));
+    }
+
+    static size_t ReadVarint(const Byte * & in) {
+        size_t value = 0;
+        for (int shift = 0; ; shift += 7) {
+            const Byte b = *in++;
+            value |= size_t(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) return value;
+        }
+    }
+
+    // Packs head XOR state, the delta from state back to head
+    void Pack() {
+        const size_t size = std::max(head.size(), state.size());
+        delta.assign(size, 0);
+        std::copy(head.begin(), head.end(), delta.begin());
+        for (size_t i = 0; i < state.size(); ++i) delta[i] ^= state[i];
+
+        packed.clear();
+        WriteVarint(packed, head.size());
+        const Byte * d = delta.data();
+        size_t i = 0;
+        while (i < size) {
+            // Most of a delta is zeros, skipped 8 bytes at a time
+            size_t zeros = i;
+            uint64_t word;
+            while ((zeros + sizeof(word) <= size) && (std::memcpy(&word, d + zeros, sizeof(word)), word == 0)) zeros += sizeof(word);
+            while ((zeros < size) && (d[zeros] == 0)) ++zeros;
+            // Literals go on over single zero bytes
+            size_t end = zeros;
+            while ((end < size) && ((d[end] != 0) || ((end + 1 < size) && (d[end + 1] != 0)))) ++end;
+            WriteVarint(packed, zeros - i);
+            WriteVarint(packed, end - zeros);
+            packed.insert(packed.end(), d + zeros, d + end);
+            i = end;
+        }
+    }
+
+    // Turns the newer state into the older one
+    static void Unpack(const Byte * in, std::vector<Byte> & target) {
+        const size_t olderSize = ReadVarint(in);
+        const size_t size = std::max(olderSize, target.size());
+        target.resize(size, 0);
+        size_t i = 0;
+        while (i < size) {
+            i += ReadVarint(in);
+            const size_t literals = ReadVarint(in);
+            for (size_t j = 0; j < literals; ++j) target[i++] ^= *in++;
+        }
+        target.resize(olderSize);
+    }
+
+    // Stores the delta of head with its inputs, dropping the oldest entries
+    // until they fit
+    void Store() {
+        Pack();
+        LastDeltaSize = packed.size();
+        const size_t size = inputs.size() + packed.size();
+        if (size > Capacity) {
+            entries.clear();
+            used = 0;
+            writePos = 0;
+            return;
+        }
+        for (;;) {
+            if (entries.empty()) {
+                writePos = 0;
+                break;
+            }
+            const size_t start = entries.front().Offset;
+            if (start >= writePos) {
+                // Free space between the newest and the oldest entries
+                if (writePos + size <= start) break;
+            }
+            else {
+                // Free space at the end of the ring, then at its start
+                if (writePos + size <= Capacity) break;
+                if (size <= start) {
+                    writePos = 0;
+                    break;
+                }
+            }
+            used -= entries.front().Size;
+            entries.pop_front();
+        }
+        std::copy(inputs.begin(), inputs.end(), ring.begin() + writePos);
+        std::copy(packed.begin(), packed.end(), ring.begin() + writePos + inputs.size());
+        entries.push_back({ headFrame, writePos, size });
+        writePos += size;
+        used += size;
+    }
+};
+
+#endif /* REWIND_H_ */
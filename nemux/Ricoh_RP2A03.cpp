@@ -1,6 +1,9 @@
 #include "Ricoh_RP2A03.h"
 
-#define M(f) (& Ricoh_RP2A03::f)
+#include <algorithm>
+
+#define M(f) (Ricoh_RP2A03::MicroOp::f)
+#define MODE(f) (& Ricoh_RP2A03::f)
 
 Ricoh_RP2A03::AddressingMode_f GetAddressingMode(Byte opcode) {
     const Byte opType = (opcode & 0b00000011);
@@ -10,83 +13,83 @@ Ricoh_RP2A03::AddressingMode_f GetAddressingMode(Byte opcode) {
     switch (opType) {
     case 0: // Control instructions
         switch (opMode) {
-        case 0:                  return M(ModeImmediate);
-        case 1: if (opCode == 4) return M(ModeZeropageWrite);
-                else             return M(ModeZeropageRead);
-        case 2:                  return M(ModeImplied);
-        case 3: if (opCode == 4) return M(ModeAbsoluteWrite);
-                else             return M(ModeAbsoluteRead);
-        case 4:                  return M(ModeRelative);
-        case 5: if (opCode == 4) return M(ModeZeropageXWrite);
-                else             return M(ModeZeropageXRead);
-        case 6:                  return M(ModeImplied);
-        case 7: if (opCode == 4) return M(ModeAbsoluteXWrite);
-                else             return M(ModeAbsoluteXRead);
+        case 0:                  return MODE(ModeImmediate);
+        case 1: if (opCode == 4) return MODE(ModeZeropageWrite);
+                else             return MODE(ModeZeropageRead);
+        case 2:                  return MODE(ModeImplied);
+        case 3: if (opCode == 4) return MODE(ModeAbsoluteWrite);
+                else             return MODE(ModeAbsoluteRead);
+        case 4:                  return MODE(ModeRelative);
+        case 5: if (opCode == 4) return MODE(ModeZeropageXWrite);
+                else             return MODE(ModeZeropageXRead);
+        case 6:                  return MODE(ModeImplied);
+        case 7: if (opCode == 4) return MODE(ModeAbsoluteXWrite);
+                else             return MODE(ModeAbsoluteXRead);
         }
         break;
     case 1: // ALU instructions
         switch (opMode) {
-        case 0: if (opCode == 4) return M(ModeIndirectXWrite);
-                else             return M(ModeIndirectXRead);
-        case 1: if (opCode == 4) return M(ModeZeropageWrite);
-                else             return M(ModeZeropageRead);
-        case 2:                  return M(ModeImmediate);
-        case 3: if (opCode == 4) return M(ModeAbsoluteWrite);
-                else             return M(ModeAbsoluteRead);
-        case 4: if (opCode == 4) return M(ModeIndirectYWrite);
-                else             return M(ModeIndirectYRead);
-        case 5: if (opCode == 4) return M(ModeZeropageXWrite);
-                else             return M(ModeZeropageXRead);
-        case 6: if (opCode == 4) return M(ModeAbsoluteYWrite);
-                else             return M(ModeAbsoluteYRead);
-        case 7: if (opCode == 4) return M(ModeAbsoluteXWrite);
-                else             return M(ModeAbsoluteXRead);
+        case 0: if (opCode == 4) return MODE(ModeIndirectXWrite);
+                else             return MODE(ModeIndirectXRead);
+        case 1: if (opCode == 4) return MODE(ModeZeropageWrite);
+                else             return MODE(ModeZeropageRead);
+        case 2:                  return MODE(ModeImmediate);
+        case 3: if (opCode == 4) return MODE(ModeAbsoluteWrite);
+                else             return MODE(ModeAbsoluteRead);
+        case 4: if (opCode == 4) return MODE(ModeIndirectYWrite);
+                else             return MODE(ModeIndirectYRead);
+        case 5: if (opCode == 4) return MODE(ModeZeropageXWrite);
+                else             return MODE(ModeZeropageXRead);
+        case 6: if (opCode == 4) return MODE(ModeAbsoluteYWrite);
+                else             return MODE(ModeAbsoluteYRead);
+        case 7: if (opCode == 4) return MODE(ModeAbsoluteXWrite);
+                else             return MODE(ModeAbsoluteXRead);
         }
         break;
     case 2: // RMW instructions
         switch (opMode) {
-        case 0:                       return M(ModeImmediate);
-        case 1: if      (opCode == 4) return M(ModeZeropageWrite);
-                else if (opCode == 5) return M(ModeZeropageRead);
-                else                  return M(ModeZeropageRMW);
-        case 2:                       return M(ModeImplied);
-        case 3: if      (opCode == 4) return M(ModeAbsoluteWrite);
-                else if (opCode == 5) return M(ModeAbsoluteRead);
-                else                  return M(ModeAbsoluteRMW);
-        case 4:                       return M(ModeImplied);
-        case 5: if      (opCode == 4) return M(ModeZeropageYWrite);
-                else if (opCode == 5) return M(ModeZeropageYRead);
-                else                  return M(ModeZeropageXRMW);
-        case 6:                       return M(ModeImplied);
-        case 7: if      (opCode == 4) return M(ModeAbsoluteYWrite);
-                else if (opCode == 5) return M(ModeAbsoluteYRead);
-                else                  return M(ModeAbsoluteXRMW);
+        case 0:                       return MODE(ModeImmediate);
+        case 1: if      (opCode == 4) return MODE(ModeZeropageWrite);
+                else if (opCode == 5) return MODE(ModeZeropageRead);
+                else                  return MODE(ModeZeropageRMW);
+        case 2:                       return MODE(ModeImplied);
+        case 3: if      (opCode == 4) return MODE(ModeAbsoluteWrite);
+                else if (opCode == 5) return MODE(ModeAbsoluteRead);
+                else                  return MODE(ModeAbsoluteRMW);
+        case 4:                       return MODE(ModeImplied);
+        case 5: if      (opCode == 4) return MODE(ModeZeropageYWrite);
+                else if (opCode == 5) return MODE(ModeZeropageYRead);
+                else                  return MODE(ModeZeropageXRMW);
+        case 6:                       return MODE(ModeImplied);
+        case 7: if      (opCode == 4) return MODE(ModeAbsoluteYWrite);
+                else if (opCode == 5) return MODE(ModeAbsoluteYRead);
+                else                  return MODE(ModeAbsoluteXRMW);
         }
         break;
     case 3: // Combined ALU/RMW instructions
         switch (opMode) {
-        case 0: if      (opCode == 4) return M(ModeIndirectXWrite);
-                else if (opCode == 5) return M(ModeIndirectXRead);
-                else                  return M(ModeIndirectXRMW);
-        case 1: if      (opCode == 4) return M(ModeZeropageWrite);
-                else if (opCode == 5) return M(ModeZeropageRead);
-                else                  return M(ModeZeropageRMW);
-        case 2:                       return M(ModeImmediate);
-        case 3: if      (opCode == 4) return M(ModeAbsoluteWrite);
-                else if (opCode == 5) return M(ModeAbsoluteRead);
-                else                  return M(ModeAbsoluteRMW); 
-        case 4: if      (opCode == 4) return M(ModeIndirectYWrite);
-                else if (opCode == 5) return M(ModeIndirectYRead);
-                else                  return M(ModeIndirectYRMW);
-        case 5: if      (opCode == 4) return M(ModeZeropageYWrite);
-                else if (opCode == 5) return M(ModeZeropageYRead);
-                else                  return M(ModeZeropageXRMW);
-        case 6: if      (opCode == 4) return M(ModeAbsoluteYWrite);
-                else if (opCode == 5) return M(ModeAbsoluteYRead);
-                else                  return M(ModeAbsoluteYRMW);
-        case 7: if      (opCode == 4) return M(ModeAbsoluteYWrite);
-                else if (opCode == 5) return M(ModeAbsoluteYRead);
-                else                  return M(ModeAbsoluteXRMW);
+        case 0: if      (opCode == 4) return MODE(ModeIndirectXWrite);
+                else if (opCode == 5) return MODE(ModeIndirectXRead);
+                else                  return MODE(ModeIndirectXRMW);
+        case 1: if      (opCode == 4) return MODE(ModeZeropageWrite);
+                else if (opCode == 5) return MODE(ModeZeropageRead);
+                else                  return MODE(ModeZeropageRMW);
+        case 2:                       return MODE(ModeImmediate);
+        case 3: if      (opCode == 4) return MODE(ModeAbsoluteWrite);
+                else if (opCode == 5) return MODE(ModeAbsoluteRead);
+                else                  return MODE(ModeAbsoluteRMW); 
+        case 4: if      (opCode == 4) return MODE(ModeIndirectYWrite);
+                else if (opCode == 5) return MODE(ModeIndirectYRead);
+                else                  return MODE(ModeIndirectYRMW);
+        case 5: if      (opCode == 4) return MODE(ModeZeropageYWrite);
+                else if (opCode == 5) return MODE(ModeZeropageYRead);
+                else                  return MODE(ModeZeropageXRMW);
+        case 6: if      (opCode == 4) return MODE(ModeAbsoluteYWrite);
+                else if (opCode == 5) return MODE(ModeAbsoluteYRead);
+                else                  return MODE(ModeAbsoluteYRMW);
+        case 7: if      (opCode == 4) return MODE(ModeAbsoluteYWrite);
+                else if (opCode == 5) return MODE(ModeAbsoluteYRead);
+                else                  return MODE(ModeAbsoluteXRMW);
         }
         break;
     }
@@ -144,8 +147,8 @@ void Ricoh_RP2A03::ModeZeropageXRMW() {
     Start(M(write_operand_to_address));
 }
 void Ricoh_RP2A03::ModeZeropageXWrite() {
-    index = X;
-    Cycle(M(read_PC_to_address),
+    Cycle(M(index_X),
+          M(read_PC_to_address),
           M(increment_PC));
     Cycle(M(read_address_to_operand),
           M(index_address));
@@ -156,16 +159,16 @@ void Ricoh_RP2A03::ModeZeropageYRead() {
     Start(M(read_address_to_operand));
 }
 void Ricoh_RP2A03::ModeZeropageYWrite() {
-    index = Y;
-    Cycle(M(read_PC_to_address),
+    Cycle(M(index_Y),
+          M(read_PC_to_address),
           M(increment_PC));
     Cycle(M(read_address_to_operand),
           M(index_address));
 }
 
 void Ricoh_RP2A03::detailAbsoluteX() {
-    index = X;
-    Cycle(M(read_PC_to_addressLo),
+    Cycle(M(index_X),
+          M(read_PC_to_addressLo),
           M(increment_PC));
     Cycle(M(read_PC_to_addressHi),
           M(increment_PC),
@@ -191,8 +194,8 @@ void Ricoh_RP2A03::ModeAbsoluteXWrite() {
 }
 
 void Ricoh_RP2A03::detailAbsoluteY() {
-    index = Y;
-    Cycle(M(read_PC_to_addressLo),
+    Cycle(M(index_Y),
+          M(read_PC_to_addressLo),
           M(increment_PC));
     Cycle(M(read_PC_to_addressHi),
           M(increment_PC),
@@ -227,8 +230,8 @@ void Ricoh_RP2A03::ModeIndirectXRMW() {
     Start(M(write_operand_to_address));
 }
 void Ricoh_RP2A03::ModeIndirectXWrite() {
-    index = X;
-    Cycle(M(read_PC_to_address),
+    Cycle(M(index_X),
+          M(read_PC_to_address),
           M(increment_PC));
     Cycle(M(read_address_to_operand),
           M(index_address));
@@ -238,8 +241,8 @@ void Ricoh_RP2A03::ModeIndirectXWrite() {
 }
 
 void Ricoh_RP2A03::detailIndirectY() {
-    index = Y;
-    Cycle(M(read_PC_to_operand),
+    Cycle(M(index_Y),
+          M(read_PC_to_operand),
           M(increment_PC));
     Cycle(M(read_operand_to_addressLo));
     Cycle(M(read_operand_1_to_addressHi),
@@ -372,8 +375,8 @@ void Ricoh_RP2A03::branch_fix_PCH() {
 void Ricoh_RP2A03::Branch(const bool condition) {
     if (condition) {
         PC = (PC & 0xFF00) + ((PC + operand) & 0x00FF);
-        operations.push(M(branch_fix_PCH));
-        operations.push(M(end_cycle));
+        pending.push(M(branch_fix_PCH));
+        pending.push(M(end_cycle));
     }
     else {
         //operations.push(M(read_PC_to_opcode_AND_increment_PC);
@@ -383,8 +386,18 @@ void Ricoh_RP2A03::Branch(const bool condition) {
 void Ricoh_RP2A03::do_DMA() {
     if (dmaTicks > 0) {
         --dmaTicks;
-        operations.push_front(M(end_cycle));
+        // Reverse order because pushing in front
         operations.push_front(M(do_DMA));
+        operations.push_front(M(end_cycle));
+    }
+}
+
+void Ricoh_RP2A03::Dispatch(const MicroOp & op) {
+    switch (op) {
+#define RP2A03_MICRO_OP_CASE(f) case MicroOp::f: f(); break;
+    RP2A03_MICRO_OPS(RP2A03_MICRO_OP_CASE)
+#undef RP2A03_MICRO_OP_CASE
+    case MicroOp::Count: break;
     }
 }
 
@@ -394,22 +407,35 @@ Ricoh_RP2A03::Ricoh_RP2A03()
     Ticks{ 0 },
     IRQ{ false }, IRQLevel{ false },
     NMI{ false }, NMIEdge{ false }, NMIFlipFlop{ false },
-    CycleActive{ false }
+    OwedCycles{ 0 },
+    decoded(0x8000),
+    decodedMap{ nullptr },
+    decodedPages{ nullptr },
+    prgGeneration{ nullptr },
+    decodedGeneration{ 0 },
+    pages{ nullptr },
+    pagesMap{ nullptr },
+    dmaSource{ 0 },
+    dmaTarget{ nullptr },
+    dmaOffset{ 0 },
+    dmaTicks{ 0 },
+    CycleActive{ false },
+    FastPath{ false }
 {
     // Build addressing mode LUT from opcode decoding
     for (int opcode = 0; opcode < 0x100; ++opcode) {
         modes[opcode] = GetAddressingMode(opcode);
     }
     // Set up special instructions
-    modes[0x20] = M(ModeJSR);          // JSR
-    modes[0x40] = M(ModeRTI);          // RTI
-    modes[0x60] = M(ModeRTS);          // RTS
-    modes[0x08] = M(ModePush);         // PHP
-    modes[0x28] = M(ModePull);         // PLP
-    modes[0x48] = M(ModePush);         // PHA
-    modes[0x68] = M(ModePull);         // PLA
-    modes[0x4C] = M(ModeJump);         // JMP
-    modes[0x6C] = M(ModeJumpIndirect); // JMP
+    modes[0x20] = MODE(ModeJSR);          // JSR
+    modes[0x40] = MODE(ModeRTI);          // RTI
+    modes[0x60] = MODE(ModeRTS);          // RTS
+    modes[0x08] = MODE(ModePush);         // PHP
+    modes[0x28] = MODE(ModePull);         // PLP
+    modes[0x48] = MODE(ModePush);         // PHA
+    modes[0x68] = MODE(ModePull);         // PLA
+    modes[0x4C] = MODE(ModeJump);         // JMP
+    modes[0x6C] = MODE(ModeJumpIndirect); // JMP
 
     // Build instruction LUT
     uOpCode = {
@@ -431,15 +457,261 @@ Ricoh_RP2A03::Ricoh_RP2A03()
 /* Ex */ M( CPX),M( SBC),M(xNOP),M(xISC),M( CPX),M( SBC),M( INC),M(xISC),M( INX),M( SBC),M( NOP), M(xSBC),M( CPX),M( SBC),M( INC),M(xISC),
 /* Fx */ M( BEQ),M( SBC),M(xHLT),M(xISC),M(xNOP),M( SBC),M( INC),M(xISC),M( SED),M( SBC),M(xNOP), M(xISC),M(xNOP),M( SBC),M( INC),M(xISC),
     };
+
+    // Cycle scripts only depend on the opcode so they are built once and
+    // shared read-only by every instance
+    static const std::array<MicroProgram, 0x100> programs = CompilePrograms();
+    Programs = &programs;
+    program = &programs[0];
+    step = program->Size;
+
+    // Classify bus accesses for the instruction-granular path
+    const struct {
+        AddressingMode_f Mode;
+        Access Addressing;
+        Bus Operation;
+    } kinds[] = {
+        { MODE(ModeZeropageRead),   Access::Zeropage,  Bus::Read  },
+        { MODE(ModeZeropageRMW),    Access::Zeropage,  Bus::RMW   },
+        { MODE(ModeZeropageWrite),  Access::Zeropage,  Bus::Write },
+        { MODE(ModeZeropageXRead),  Access::ZeropageX, Bus::Read  },
+        { MODE(ModeZeropageXRMW),   Access::ZeropageX, Bus::RMW   },
+        { MODE(ModeZeropageXWrite), Access::ZeropageX, Bus::Write },
+        { MODE(ModeZeropageYRead),  Access::ZeropageY, Bus::Read  },
+        { MODE(ModeZeropageYWrite), Access::ZeropageY, Bus::Write },
+        { MODE(ModeAbsoluteRead),   Access::Absolute,  Bus::Read  },
+        { MODE(ModeAbsoluteRMW),    Access::Absolute,  Bus::RMW   },
+        { MODE(ModeAbsoluteWrite),  Access::Absolute,  Bus::Write },
+        { MODE(ModeAbsoluteXRead),  Access::AbsoluteX, Bus::Read  },
+        { MODE(ModeAbsoluteXRMW),   Access::AbsoluteX, Bus::RMW   },
+        { MODE(ModeAbsoluteXWrite), Access::AbsoluteX, Bus::Write },
+        { MODE(ModeAbsoluteYRead),  Access::AbsoluteY, Bus::Read  },
+        { MODE(ModeAbsoluteYRMW),   Access::AbsoluteY, Bus::RMW   },
+        { MODE(ModeAbsoluteYWrite), Access::AbsoluteY, Bus::Write },
+        { MODE(ModeIndirectXRead),  Access::IndirectX, Bus::Read  },
+        { MODE(ModeIndirectXRMW),   Access::IndirectX, Bus::RMW   },
+        { MODE(ModeIndirectXWrite), Access::IndirectX, Bus::Write },
+        { MODE(ModeIndirectYRead),  Access::IndirectY, Bus::Read  },
+        { MODE(ModeIndirectYRMW),   Access::IndirectY, Bus::RMW   },
+        { MODE(ModeIndirectYWrite), Access::IndirectY, Bus::Write },
+    };
+    for (int opcode = 0; opcode < 0x100; ++opcode) {
+        auto & fast = fastOps[opcode];
+        fast.Addressing = Access::Program;
+        fast.Operation = Bus::None;
+        if ((modes[opcode] == MODE(ModeImmediate)) || (modes[opcode] == MODE(ModeRelative))) {
+            fast.Addressing = Access::Immediate;
+        }
+        for (const auto & kind : kinds) {
+            if (modes[opcode] == kind.Mode) {
+                fast.Addressing = kind.Addressing;
+                fast.Operation = kind.Operation;
+            }
+        }
+        // Opcode fetch plus the static cycles of the program
+        const auto & compiled = programs[opcode];
+        fast.Cycles = 1 + std::count(compiled.Ops.begin(), compiled.Ops.begin() + compiled.Size, M(end_cycle));
+    }
+    fastOps[0x6C].Addressing = Access::Indirect;
+    for (const Byte opcode : { 0x93, 0x9B, 0x9C, 0x9E, 0x9F }) {
+        fastOps[opcode].Addressing = Access::Unstable;
+    }
+}
+
+std::array<Ricoh_RP2A03::MicroProgram, 0x100> Ricoh_RP2A03::CompilePrograms() {
+    std::array<MicroProgram, 0x100> result;
+    for (int opcode = 0; opcode < 0x100; ++opcode) {
+        pending.clear();
+        (this->*modes[opcode])();
+        Finish(uOpCode[opcode]);
+
+        auto & compiled = result[opcode];
+        compiled.Size = 0;
+        while (!pending.empty()) compiled.Ops[compiled.Size++] = pending.pop();
+    }
+    pending.clear();
+    return result;
+}
+
+void Ricoh_RP2A03::SaveQueue(StateWriter & state, CircularQueue<MicroOp, 64> queue) const {
+    const Byte size = Byte(queue.size());
+    state(size);
+    while (!queue.empty()) state(queue.pop());
+}
+
+void Ricoh_RP2A03::LoadQueue(StateReader & state, CircularQueue<MicroOp, 64> & queue) {
+    Byte size;
+    state(size);
+    queue.clear();
+    for (Byte i = 0; i < size; ++i) {
+        MicroOp op;
+        state(op);
+        if (op >= MicroOp::Count) throw invalid_format("Invalid micro-op in state");
+        queue.push(op);
+    }
+}
+
+void Ricoh_RP2A03::SaveState(StateWriter & state) const {
+    const Byte current = Byte(program - Programs->data());
+    state(PC, S, A, X, Y, N, V, D, I, Z, C, Ticks,
+        vector, address, index, operand, Pflag, AddressWasFixed, CheckInterrupts,
+        NMIEdge, NMIFlipFlop, IRQLevel, IRQ, NMI, opcode, Halted, INSTR, CycleActive,
+        OwedCycles, dmaSource, dmaOffset, dmaTicks, current, step);
+    SaveQueue(state, operations);
+    SaveQueue(state, pending);
+}
+
+void Ricoh_RP2A03::LoadState(StateReader & state) {
+    Byte current;
+    state(PC, S, A, X, Y, N, V, D, I, Z, C, Ticks,
+        vector, address, index, operand, Pflag, AddressWasFixed, CheckInterrupts,
+        NMIEdge, NMIFlipFlop, IRQLevel, IRQ, NMI, opcode, Halted, INSTR, CycleActive,
+        OwedCycles, dmaSource, dmaOffset, dmaTicks, current, step);
+    program = &(*Programs)[current];
+    if (step > program->Size) throw invalid_format("Invalid micro-op in state");
+    LoadQueue(state, operations);
+    LoadQueue(state, pending);
+
+    // The banks may have changed under the decoded instructions
+    decodedMap = nullptr;
+    pagesMap = nullptr;
+}
+
+int Ricoh_RP2A03::RunQueued() {
+    int cycles = 0;
+    CycleActive = true;
+    while (Busy()) {
+        ConsumeOne();
+        if (!CycleActive) {
+            ++cycles;
+            CycleActive = true;
+        }
+    }
+    CycleActive = false;
+    return cycles;
+}
+
+void Ricoh_RP2A03::DropSwitchedPages(const bool all) {
+    for (size_t page = 0; page < DECODED_PAGES; ++page) {
+        const auto from = (decodedPages != nullptr) ? decodedPages->Read[DECODED_PAGES + page] : nullptr;
+        if (!all && (from != nullptr) && (from == decodedFrom[page])) continue;
+        decodedFrom[page] = from;
+        const auto first = decoded.begin() + page * PageTable::PAGE_SIZE;
+        std::fill(first, first + PageTable::PAGE_SIZE, Decoded{});
+        // The operands of the last instructions of the page before
+        if (page > 0) std::fill(first - 2, first, Decoded{});
+    }
+}
+
+const Ricoh_RP2A03::Decoded & Ricoh_RP2A03::Decode(const Word & pc) {
+    if (Map != decodedMap) {
+        decodedMap = Map;
+        decodedPages = Map->DirectPages();
+        prgGeneration = Map->PrgGeneration();
+        decodedGeneration = (prgGeneration != nullptr) ? *prgGeneration : 0;
+        DropSwitchedPages(true);
+    }
+    if ((prgGeneration == nullptr) || (pc < 0x8000) || (pc > 0xFFFD)) {
+        fetched = { GetByteAt(pc), GetByteAt(pc + 1), GetByteAt(pc + 2), true };
+        return fetched;
+    }
+    if (*prgGeneration != decodedGeneration) {
+        decodedGeneration = *prgGeneration;
+        DropSwitchedPages(false);
+    }
+    auto & instruction = decoded[pc - 0x8000];
+    if (!instruction.Valid) {
+        instruction = { GetByteAt(pc), GetByteAt(pc + 1), GetByteAt(pc + 2), true };
+    }
+    return instruction;
+}
+
+bool Ricoh_RP2A03::RunInstruction() {
+    // Interrupt sequences, DMA and pending interrupts stay cycle exact
+    if (Busy()) return false;
+    if (CheckInterrupts && (NMIFlipFlop || IRQLevel)) return false;
+    if (IsIO(PC) || IsIO(PC + 2)) return false;
+
+    const auto & instruction = Decode(PC);
+    const Byte op = instruction.Opcode;
+    const Byte lo = instruction.Lo;
+    const Word absolute = lo | (instruction.Hi << BYTE_WIDTH);
+    const auto & fast = fastOps[op];
+    int cycles = fast.Cycles;
+    if (fast.Addressing == Access::Unstable) return false;
+    if (fast.Addressing == Access::Indirect) {
+        if (IsIO(absolute) || IsIO((absolute & WORD_HI_MASK) | Byte(absolute + 1))) return false;
+    }
+    if ((fast.Addressing == Access::Program) || (fast.Addressing == Access::Indirect)) {
+        CheckInterrupts = true;
+        opcode = op;
+        increment_PC();
+        ProcessOpcode();
+        OwedCycles = RunQueued();
+        return true;
+    }
+
+    // Resolve the effective address once, the operand is read only if no
+    // access (including the dummy read before a page fix) reaches I/O
+    const auto zeropage = [this](const Byte & pointer) {
+        return Word(GetByteAt(pointer) | (GetByteAt(Byte(pointer + 1)) << BYTE_WIDTH));
+    };
+    Word base = absolute;
+    Byte offset = 0;
+    Word length = 2;
+    switch (fast.Addressing) {
+    case Access::Immediate: operand = lo;                    break;
+    case Access::Zeropage:  address = lo;                    break;
+    case Access::ZeropageX: address = Byte(lo + X);          break;
+    case Access::ZeropageY: address = Byte(lo + Y);          break;
+    case Access::IndirectX: address = zeropage(lo + X);      break;
+    case Access::IndirectY: base = zeropage(lo); offset = Y; break;
+    case Access::AbsoluteX: offset = X; length = 3;          break;
+    case Access::AbsoluteY: offset = Y; length = 3;          break;
+    default:                address = absolute; length = 3;  break;
+    }
+    const bool indexed = (fast.Addressing == Access::AbsoluteX)
+                      || (fast.Addressing == Access::AbsoluteY)
+                      || (fast.Addressing == Access::IndirectY);
+    if (indexed) {
+        address = base + offset;
+        const Word unfixed = (base & WORD_HI_MASK) | (address & WORD_LO_MASK);
+        if (IsIO(unfixed)) return false;
+        index = offset;
+        AddressWasFixed = (unfixed != address);
+        if (AddressWasFixed && (fast.Operation == Bus::Read)) ++cycles;
+    }
+    if ((fast.Operation != Bus::None) && IsIO(address)) return false;
+
+    CheckInterrupts = true;
+    opcode = op;
+    PC += length;
+    if ((fast.Operation == Bus::Read) || (fast.Operation == Bus::RMW)) operand = GetByteAt(address);
+    if (fast.Operation == Bus::RMW) SetByteAt(address, operand);
+    Dispatch(uOpCode[op]);
+    // RMW write-back, taken branches
+    cycles += RunQueued();
+
+    OwedCycles = cycles - 1;
+    return true;
 }
 
 void Ricoh_RP2A03::Phi1() {
     if (Halted) return;
 
     ++Ticks;
-    CycleActive = true;
-    while (CycleActive) ConsumeOne();
-    INSTR = (operations.empty() | (operations.first() == M(fetch_opcode)));
+    if (Map != pagesMap) {
+        pagesMap = Map;
+        pages = (Map != nullptr) ? Map->DirectPages() : nullptr;
+    }
+    if (OwedCycles > 0) {
+        --OwedCycles;
+    }
+    else if (!(FastPath && RunInstruction())) {
+        CycleActive = true;
+        while (CycleActive) ConsumeOne();
+    }
+    INSTR = (OwedCycles == 0) && !Busy();
 }
 
 void Ricoh_RP2A03::Phi2() {
@@ -500,37 +772,37 @@ Byte Ricoh_RP2A03::Pull() {
 
 
 void Ricoh_RP2A03::Cycle() {
-    operations.push(M(end_cycle));
-}
-void Ricoh_RP2A03::Cycle(const MicroOp_f & op) {
-    operations.push(op);
-    operations.push(M(end_cycle));
-}
-void Ricoh_RP2A03::Cycle(const MicroOp_f & op1, const MicroOp_f & op2) {
-    operations.push(op1);
-    operations.push(op2);
-    operations.push(M(end_cycle));
-}
-void Ricoh_RP2A03::Cycle(const MicroOp_f & op1, const MicroOp_f & op2, const MicroOp_f & op3) {
-    operations.push(op1);
-    operations.push(op2);
-    operations.push(op3);
-    operations.push(M(end_cycle));
-}
-void Ricoh_RP2A03::Start(const MicroOp_f & op) {
-    operations.push(op);
-}
-void Ricoh_RP2A03::Start(const MicroOp_f & op1, const MicroOp_f & op2) {
-    operations.push(op1);
-    operations.push(op2);
-}
-void Ricoh_RP2A03::Start(const MicroOp_f & op1, const MicroOp_f & op2, const MicroOp_f & op3) {
-    operations.push(op1);
-    operations.push(op2);
-    operations.push(op3);
-}
-void Ricoh_RP2A03::Finish(const MicroOp_f & op) {
-    operations.push(op);
-    operations.push(M(end_cycle));
+    pending.push(M(end_cycle));
+}
+void Ricoh_RP2A03::Cycle(const MicroOp & op) {
+    pending.push(op);
+    pending.push(M(end_cycle));
+}
+void Ricoh_RP2A03::Cycle(const MicroOp & op1, const MicroOp & op2) {
+    pending.push(op1);
+    pending.push(op2);
+    pending.push(M(end_cycle));
+}
+void Ricoh_RP2A03::Cycle(const MicroOp & op1, const MicroOp & op2, const MicroOp & op3) {
+    pending.push(op1);
+    pending.push(op2);
+    pending.push(op3);
+    pending.push(M(end_cycle));
+}
+void Ricoh_RP2A03::Start(const MicroOp & op) {
+    pending.push(op);
+}
+void Ricoh_RP2A03::Start(const MicroOp & op1, const MicroOp & op2) {
+    pending.push(op1);
+    pending.push(op2);
+}
+void Ricoh_RP2A03::Start(const MicroOp & op1, const MicroOp & op2, const MicroOp & op3) {
+    pending.push(op1);
+    pending.push(op2);
+    pending.push(op3);
+}
+void Ricoh_RP2A03::Finish(const MicroOp & op) {
+    pending.push(op);
+    pending.push(M(end_cycle));
 }
 
@@ -4,12 +4,35 @@
 #include "Types.h"
 #include "MemoryMap.h"
 #include "CircularQueue.h"
+#include "State.h"
 
 #include <string>
 #include <vector>
 
 #include <iostream>
 
+// Everything the queues can hold, the cycle scripts of the addressing modes
+// and the instructions themselves
+#define RP2A03_MICRO_OPS(OP) \
+    OP(end_cycle) OP(do_DMA) OP(branch_fix_PCH) OP(queue_read_if_address_fixed) \
+    OP(increment_PC) OP(read_PC_to_operand) OP(push_PCL) OP(push_PCH) OP(push_P) \
+    OP(pull_PCL) OP(pull_PCH) OP(pull_P) OP(read_PC_to_address) \
+    OP(read_PC_to_addressLo) OP(read_PC_to_addressHi) OP(read_address_to_operand) \
+    OP(read_operand_to_addressLo) OP(read_operand_1_to_addressHi) OP(index_X) OP(index_Y) \
+    OP(index_address) OP(fix_indexed_address) OP(write_operand_to_address) \
+    OP(read_vector_to_PCL) OP(read_vector_to_PCH) OP(read_address_and_operand_to_address) \
+    OP(move_address_to_operand) OP(decrement_S) \
+    OP(NOP) OP(JMP) OP(BRK) OP(JSR) OP(RTI) OP(RTS) OP(PHP) OP(PLP) OP(PHA) OP(PLA) \
+    OP(BCC) OP(BCS) OP(BNE) OP(BEQ) OP(BPL) OP(BMI) OP(BVC) OP(BVS) \
+    OP(CLC) OP(SEC) OP(CLI) OP(SEI) OP(CLV) OP(CLD) OP(SED) \
+    OP(INX) OP(DEX) OP(INY) OP(DEY) OP(LDA) OP(LDX) OP(LDY) OP(STA) OP(STX) OP(STY) \
+    OP(TAX) OP(TAY) OP(TXA) OP(TYA) OP(TSX) OP(TXS) OP(CMP) OP(CPX) OP(CPY) \
+    OP(ORA) OP(AND) OP(EOR) OP(ADC) OP(SBC) OP(ASLa) OP(ROLa) OP(LSRa) OP(RORa) \
+    OP(ASL) OP(ROL) OP(LSR) OP(ROR) OP(DEC) OP(INC) OP(BIT) \
+    OP(xNOP) OP(xHLT) OP(xSHX) OP(xSHY) OP(xSLO) OP(xRLA) OP(xSRE) OP(xRRA) \
+    OP(xDCP) OP(xISC) OP(xANC) OP(xALR) OP(xARR) OP(xXAA) OP(xAHX) OP(xTAS) \
+    OP(xLAS) OP(xAXS) OP(xSBC) OP(xSAX) OP(xLAX)
+
 class Ricoh_RP2A03 {
 
 
@@ -34,18 +57,31 @@ class Ricoh_RP2A03 {
         Left = 7, Right = 0,
     };
 
-    inline Byte GetByteAt(const Word & address) const { return Map->GetByteAt(address); }
+    inline Byte GetByteAt(const Word & address) const {
+        if (pages != nullptr) {
+            const auto page = pages->Read[PageTable::Page(address)];
+            if (page != nullptr) return page[address & PageTable::PAGE_MASK];
+        }
+        return Map->GetByteAt(address);
+    }
     inline void SetByteAt(const Word & address, const Byte & value) {
         //if (address == 0x2000) std::cout << "$2000 <- $" << std::hex << int(value) << std::endl;
+        if (pages != nullptr) {
+            const auto page = pages->Write[PageTable::Page(address)];
+            if (page != nullptr) {
+                page[address & PageTable::PAGE_MASK] = value;
+                return;
+            }
+        }
         Map->SetByteAt(address, value);
     }
 
     // ops state
-    Word vector;
-    Word address;
-    Byte index;
-    Byte operand;
-    Flag Pflag;
+    Word vector = 0;
+    Word address = 0;
+    Byte index = 0;
+    Byte operand = 0;
+    Flag Pflag = 0;
     bool AddressWasFixed = false;
     bool CheckInterrupts = true;
 
@@ -63,6 +99,8 @@ class Ricoh_RP2A03 {
     inline void read_address_to_operand()             { operand = GetByteAt(address); }
     inline void read_operand_to_addressLo()           { SetLo(address, GetByteAt(operand)); }
     inline void read_operand_1_to_addressHi()         { SetHi(address, GetByteAt(Byte(operand + 1))); }
+    inline void index_X()                             { index = X; }
+    inline void index_Y()                             { index = Y; }
     inline void index_address()                       { SetLo(address, address + index); }
     inline void fix_indexed_address()                 { AddressWasFixed = (Byte(address) < index); if (AddressWasFixed) address += 0x0100; }
     inline void write_operand_to_address()            { SetByteAt(address, operand); }
@@ -77,10 +115,8 @@ class Ricoh_RP2A03 {
     inline bool interrupted() {
         // If an interrupt sequence was running (CheckInterrupts == false)
         // do not queue another interrupt but let one instruction run
-        static int nmic = 0;
         if (CheckInterrupts) {
             if (NMIFlipFlop) {
-                //std::cout << Id << " NMI " << nmic++ << std::endl;
                 NMIFlipFlop = false;
                 trigger_interrupt(VECTOR_NMI, false, false);
                 return true;
@@ -229,27 +265,57 @@ class Ricoh_RP2A03 {
     inline void xLAX() { LDA(); TAX(); }
 
 public:
-    typedef void(Ricoh_RP2A03::* MicroOp_f)();
+    // Queued micro-ops are one byte ids, run by a switch so their bodies
+    // inline and the queues are plain bytes
+    enum class MicroOp : Byte {
+#define RP2A03_MICRO_OP_ID(f) f,
+        RP2A03_MICRO_OPS(RP2A03_MICRO_OP_ID)
+#undef RP2A03_MICRO_OP_ID
+        Count
+    };
+    void Dispatch(const MicroOp & op);
+
     typedef void(Ricoh_RP2A03::* AddressingMode_f)();
-    std::array<MicroOp_f, 0x100> uOpCode;
+    std::array<MicroOp, 0x100> uOpCode;
 
     std::array<AddressingMode_f, 0x100> modes;
 
-    CircularQueue<MicroOp_f, 64> operations;
+    // Cycle script of an instruction, as queued by its addressing mode
+    // followed by the instruction itself
+    struct MicroProgram {
+        std::array<MicroOp, 24> Ops;
+        size_t Size;
+    };
+    const std::array<MicroProgram, 0x100> * Programs;
+    std::array<MicroProgram, 0x100> CompilePrograms();
+
+    void SaveQueue(StateWriter & state, CircularQueue<MicroOp, 64> queue) const;
+    void LoadQueue(StateReader & state, CircularQueue<MicroOp, 64> & queue);
+
+    // Work runs in order: injected operations (DMA, page crossing fix-ups),
+    // then the program of the current instruction, then pending operations
+    // (interrupt sequences, RMW write-backs, taken branches)
+    CircularQueue<MicroOp, 64> operations;
+    const MicroProgram * program;
+    size_t step = 0;
+    CircularQueue<MicroOp, 64> pending;
+    bool Busy() const {
+        return !operations.empty() || (step < program->Size) || !pending.empty();
+    }
     void Cycle();
-    void Cycle(const MicroOp_f & op);
-    void Cycle(const MicroOp_f & op1,
-               const MicroOp_f & op2);
-    void Cycle(const MicroOp_f & op1,
-               const MicroOp_f & op2,
-               const MicroOp_f & op3);
-    void Start(const MicroOp_f & op);
-    void Start(const MicroOp_f & op1,
-               const MicroOp_f & op2);
-    void Start(const MicroOp_f & op1,
-               const MicroOp_f & op2,
-               const MicroOp_f & op3);
-    void Finish(const MicroOp_f & op);
+    void Cycle(const MicroOp & op);
+    void Cycle(const MicroOp & op1,
+               const MicroOp & op2);
+    void Cycle(const MicroOp & op1,
+               const MicroOp & op2,
+               const MicroOp & op3);
+    void Start(const MicroOp & op);
+    void Start(const MicroOp & op1,
+               const MicroOp & op2);
+    void Start(const MicroOp & op1,
+               const MicroOp & op2,
+               const MicroOp & op3);
+    void Finish(const MicroOp & op);
 
 
     bool NMIEdge;
@@ -334,11 +400,9 @@ public:
     inline void ModeJSR();
     
     bool ProcessOpcode() {
-        AddressingMode_f mode = modes[opcode];
-        
-        (this->*mode)();
-        Finish(uOpCode[opcode]);
-        
+        program = &(*Programs)[opcode];
+        step = 0;
+
         return true;
     }
 
@@ -349,13 +413,77 @@ public:
     inline void do_DMA();
     bool INSTR = false;
     void ConsumeOne() {
-        if (operations.empty()) {
-            Cycle(&Ricoh_RP2A03::fetch_opcode);
+        MicroOp op;
+        if (!operations.empty()) {
+            op = operations.pop();
+        }
+        else if (step < program->Size) {
+            op = program->Ops[step++];
+        }
+        else if (!pending.empty()) {
+            op = pending.pop();
+        }
+        else {
+            fetch_opcode();
+            end_cycle();
+            return;
         }
-        const auto op = operations.pop();
-        (this->*op)();
+        Dispatch(op);
     }
 
+    // Instruction-granular execution
+    // The whole program runs in the first cycle and the remaining cycles are
+    // owed, so bus accesses lose their intra-instruction timing
+    enum class Access : Byte {
+        Program,    // Replays the cycle script, touches only PC, stack and vectors
+        Immediate,  // Also relative branches
+        Zeropage,
+        ZeropageX,
+        ZeropageY,
+        Absolute,
+        AbsoluteX,
+        AbsoluteY,
+        IndirectX,
+        IndirectY,
+        Indirect,   // JMP, replays the cycle script
+        Unstable,   // SHX, SHY, AHX, TAS may write to a corrupted address
+    };
+    enum class Bus : Byte { None, Read, RMW, Write };
+    struct FastOp {
+        Access Addressing;
+        Bus Operation;
+        int Cycles;
+    };
+    std::array<FastOp, 0x100> fastOps;
+    int OwedCycles;
+    static bool IsIO(const Word & address) { return (0x2000 <= address) && (address < 0x4020); }
+    int RunQueued();
+    bool RunInstruction();
+
+    // Decoded instructions of the cartridge space, by page along with the
+    // memory each page was decoded from: a bank switch only drops the pages
+    // that show other memory, all of them without a page table
+    struct Decoded {
+        Byte Opcode;
+        Byte Lo;
+        Byte Hi;
+        bool Valid;
+    };
+    static constexpr size_t DECODED_PAGES = 0x8000 >> PageTable::PAGE_BITS;
+    std::vector<Decoded> decoded;
+    std::array<const Byte *, DECODED_PAGES> decodedFrom;
+    Decoded fetched;
+    const MemoryMap * decodedMap;
+    const PageTable * decodedPages;
+    const size_t * prgGeneration;
+    size_t decodedGeneration;
+    const Decoded & Decode(const Word & pc);
+    void DropSwitchedPages(const bool all);
+
+    // Memory reached without going through Map, refreshed when Map changes
+    const PageTable * pages;
+    const MemoryMap * pagesMap;
+
     Word dmaSource;
     Byte * dmaTarget;
     Byte dmaOffset;
@@ -388,10 +516,17 @@ public:
     bool IRQ;
     bool NMI;
 
+    // Opt-in: run instructions that only touch RAM and cartridge space in
+    // a single step, falling back to micro-ops around I/O and interrupts
+    bool FastPath;
+
     MemoryMap * Map;
 
     explicit Ricoh_RP2A03();
     void Reset();
+    // Registers, micro-op queues and the instruction in progress
+    void SaveState(StateWriter & state) const;
+    void LoadState(StateReader & state);
     void DMA(const Byte & fromHi, Byte * to, const Byte & offset);
     void Phi1();
     void Phi2();
@@ -4,21 +4,25 @@
 #include "Types.h"
 #include "MemoryMap.h"
 #include "CircularQueue.h"
+#include "State.h"
+#include "TileDecoder.h"
 
 #include <string>
 #include <vector>
 
 #include <iostream>
 
+// Map_t is the PPU bus, a concrete memory map lets fetches be inlined
+template <class Map_t = MemoryMap>
 class Ricoh_RP2C02 {
 public:
-    Word v;
-    Word t;
-    Byte x;
-    Flag w;
+    Word v = 0;
+    Word t = 0;
+    Byte x = 0;
+    Flag w = 0;
 
-    std::array<Byte, 8> OAM2_SpriteId;
-    std::array<Byte, 64> OAM2;
+    std::array<Byte, 8> OAM2_SpriteId = {{}};
+    std::array<Byte, 64> OAM2 = {{}};
 
     static void SetCoarseX  (Word & w, const Byte & b) { w = (w & ~0x001F) | (b & 0x1F); }
     static void SetCoarseY  (Word & w, const Byte & b) { w = (w & ~0x03E0) | ((b & 0x1F) << 5); }
@@ -345,6 +349,52 @@ public:
         else if (ix < 257) BuildSprite(); // Active frame
     }
 
+    // Tile spans
+    // Dots 8k+1 to 8k+8 of an active scanline fetch a tile, shift 8
+    // background pixels out and latch the tile. When no register access can
+    // land inside, they run in one call: the fetches first, then the 8
+    // background pixels decoded at once, then sprites dot by dot
+    static constexpr size_t TILE_DOTS = tile::WIDTH;
+
+    bool AtTileSpan() const {
+        const auto dot = Ticks % VIDEO_WIDTH;
+        return (Ticks < FRAME_HEIGHT * VIDEO_WIDTH) && (dot % TILE_DOTS == 1) && (dot < FRAME_WIDTH);
+    }
+
+    // Same as TILE_DOTS calls to Tick from AtTileSpan(), the pixels of the
+    // dots go to pixels
+    void TickTile(Byte * pixels) {
+        const auto first = Ticks % VIDEO_WIDTH;
+        iy = Ticks / VIDEO_WIDTH;
+
+        ReadNT();
+        ReadAT();
+        ReadBGLo();
+        ReadBGHi();
+
+        std::array<Byte, TILE_DOTS> background = {{}};
+        if (ShowBackground) {
+            tile::Decode(Byte(patternLo >> (8 - x)), Byte(patternHi >> (8 - x)),
+                Byte(attrLo >> (8 - x)), Byte(attrHi >> (8 - x)), background.data());
+            patternLo <<= TILE_DOTS;
+            patternHi <<= TILE_DOTS;
+            attrLo <<= TILE_DOTS;
+            attrHi <<= TILE_DOTS;
+        }
+
+        for (size_t i = 0; i < TILE_DOTS; ++i) {
+            ix = first + i;
+            bBG = background[i];
+            bSprite = 0;
+            if (i == TILE_DOTS - 1) SL_TickBG();
+            SL_PrepareSprite();
+            BuildSprite();
+            pixel = GetPixel(bBG, bSprite);
+            pixels[i] = pixel;
+        }
+        Ticks += TILE_DOTS;
+    }
+
     // $2000
     Byte VramIncrement;
     Word SpriteTable;
@@ -416,15 +466,15 @@ public:
         }
     }
 
-    Word aNT, aAT;
-    Byte bNT, bAT, bBGLo, bBGHi;
-    Byte bBG;
-    Word patternLo, patternHi, attrLo, attrHi;
-    Byte pixel;
+    Word aNT = 0, aAT = 0;
+    Byte bNT = 0, bAT = 0, bBGLo = 0, bBGHi = 0;
+    Byte bBG = 0;
+    Word patternLo = 0, patternHi = 0, attrLo = 0, attrHi = 0;
+    Byte pixel = 0;
 
-    size_t iSprite, iByte;
-    Byte bSprite;
-    bool BGPriority;
+    size_t iSprite = 0, iByte = 0;
+    Byte bSprite = 0;
+    bool BGPriority = false;
     struct SpriteUnit {
         Byte Id;
         Byte X, Y;
@@ -434,7 +484,17 @@ public:
         Word aLo, aHi;
         Byte Lo, Hi;
     };
-    std::array<SpriteUnit, 8> Sprites;
+    std::array<SpriteUnit, 8> Sprites = {{}};
+
+    // Map and pOAM are wiring, not state
+    template <class State_t>
+    void Serialize(State_t & state) {
+        state(v, t, x, w, OAM2_SpriteId, OAM2,
+            VramIncrement, SpriteTable, BackgroundTable, SpriteHeight, SpriteZeroHit,
+            ShowBackground, ShowSprite, IsGreyscale, Ticks, Frame, VBlank, ix, iy,
+            aNT, aAT, bNT, bAT, bBGLo, bBGHi, bBG, patternLo, patternHi, attrLo, attrHi, pixel,
+            iSprite, iByte, bSprite, BGPriority, Sprites);
+    }
 public:
     static constexpr char * Id = "2C02";
     static constexpr char * Name = "Ricoh RP2C02";
@@ -452,7 +512,7 @@ public:
     static constexpr Byte SPRITE_WIDTH = 8;
     static constexpr Byte SPRITE_PALETTE = 0x10;
 
-    MemoryMap * Map;
+    Map_t * Map;
     std::array<Byte, 0x0100> * pOAM;
 
 
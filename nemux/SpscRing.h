@@ -0,0 +1,68 @@
+/*
+ * SpscRing.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: scorder
+ */
+
+#ifndef SPSC_RING_H_
+#define SPSC_RING_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+
+// Fixed capacity ring between exactly one producer thread and one consumer
+// thread, neither ever waits for the other
+// The producer only writes tail and the consumer only writes head, each
+// publishes its items with a release store read back with acquire
+template <typename _T, size_t _Size>
+class SpscRing {
+    static_assert((_Size & (_Size - 1)) == 0, "Size must be a power of 2");
+
+    std::array<_T, _Size> items;
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+
+public:
+    explicit SpscRing() : head(0), tail(0), Underruns(0), Overruns(0) {}
+
+    // Reads the consumer could not fully serve
+    std::atomic<size_t> Underruns;
+    // Items the producer had to drop because the ring was full
+    std::atomic<size_t> Overruns;
+
+    static constexpr size_t Capacity() { return _Size; }
+
+    // Consumer side
+    size_t Available() const {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_relaxed);
+    }
+
+    // Producer side, returns how many items fit
+    size_t Push(const _T * data, const size_t count) {
+        const auto t = tail.load(std::memory_order_relaxed);
+        const auto free = _Size - (t - head.load(std::memory_order_acquire));
+        const auto n = std::min(count, free);
+        for (size_t i = 0; i < n; ++i) items[(t + i) & (_Size - 1)] = data[i];
+        tail.store(t + n, std::memory_order_release);
+        if (n < count) Overruns.fetch_add(count - n, std::memory_order_relaxed);
+        return n;
+    }
+
+    // Consumer side, all or nothing so a short read does not eat into the
+    // next one, returns false on underrun
+    bool Pop(_T * out, const size_t count) {
+        const auto h = head.load(std::memory_order_relaxed);
+        const auto available = tail.load(std::memory_order_acquire) - h;
+        if (available < count) {
+            Underruns.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        for (size_t i = 0; i < count; ++i) out[i] = items[(h + i) & (_Size - 1)];
+        head.store(h + count, std::memory_order_release);
+        return true;
+    }
+};
+
+#endif /* SPSC_RING_H_ */
@@ -0,0 +1,76 @@
+/*
+ * State.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: scorder
+ */
+
+#ifndef STATE_H_
+#define STATE_H_
+
+#include "Types.h"
+#include "Error.h"
+
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+// Save states are the fields of every component copied back to back in a
+// fixed order, in host byte order and without padding
+// Components list their fields once in Serialize(State_t & state), which
+// StateWriter and StateReader run to save and load them
+// Pointers, caches and output (frame, audio) are not part of the state
+
+static constexpr uint32_t STATE_MAGIC = 0x53584D4E; // "NMXS"
+static constexpr uint32_t STATE_VERSION = 3;
+
+class StateWriter {
+public:
+    explicit StateWriter(std::vector<Byte> & data) : data(data) {}
+
+    void operator()() {}
+
+    template <class T, class... Rest>
+    void operator()(const T & value, const Rest &... rest) {
+        static_assert(std::is_trivially_copyable<T>::value, "State fields are copied as is");
+        Bytes(&value, sizeof(T));
+        (*this)(rest...);
+    }
+
+    void Bytes(const void * source, const size_t size) {
+        const auto offset = data.size();
+        data.resize(offset + size);
+        std::memcpy(data.data() + offset, source, size);
+    }
+
+private:
+    std::vector<Byte> & data;
+};
+
+class StateReader {
+public:
+    explicit StateReader(const std::vector<Byte> & data) : data(data), offset(0) {}
+
+    void operator()() {}
+
+    template <class T, class... Rest>
+    void operator()(T & value, Rest &... rest) {
+        static_assert(std::is_trivially_copyable<T>::value, "State fields are copied as is");
+        Bytes(&value, sizeof(T));
+        (*this)(rest...);
+    }
+
+    void Bytes(void * target, const size_t size) {
+        if (size > data.size() - offset) throw invalid_format("Truncated state");
+        std::memcpy(target, data.data() + offset, size);
+        offset += size;
+    }
+
+    bool AtEnd() const { return offset == data.size(); }
+
+private:
+    const std::vector<Byte> & data;
+    size_t offset;
+};
+
+#endif /* STATE_H_ */
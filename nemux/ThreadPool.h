@@ -0,0 +1,99 @@
+/*
+ * ThreadPool.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: scorder
+ */
+
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs a batch of independent jobs on a fixed number of threads
+// Jobs are dealt round robin to one queue per worker, a worker takes from
+// the back of its own queue and steals from the front of the others once
+// it runs dry, so long jobs do not leave the other cores idle
+// No job is added while a batch runs, a worker finding every queue empty
+// is done
+class ThreadPool {
+public:
+    typedef std::function<void()> Job;
+
+    // 0 threads means one per hardware thread
+    explicit ThreadPool(const size_t threads = 0)
+        : Threads(threads > 0 ? threads : std::max<size_t>(1, std::thread::hardware_concurrency())) {}
+
+    const size_t Threads;
+
+    // Blocks until every job ran, the first exception thrown by a job is
+    // rethrown here once all workers stopped
+    void Run(const std::vector<Job> & jobs) {
+        const auto workers = std::max<size_t>(1, std::min(Threads, jobs.size()));
+        queues.clear();
+        for (size_t w = 0; w < workers; ++w) queues.emplace_back(new Queue);
+        for (size_t i = 0; i < jobs.size(); ++i) queues[i % workers]->Jobs.push_back(&jobs[i]);
+        failure = nullptr;
+
+        std::vector<std::thread> threads;
+        for (size_t w = 1; w < workers; ++w) threads.emplace_back(&ThreadPool::Work, this, w);
+        Work(0);
+        for (auto & thread : threads) thread.join();
+
+        queues.clear();
+        if (failure) std::rethrow_exception(failure);
+    }
+
+private:
+    struct Queue {
+        std::mutex Lock;
+        std::deque<const Job *> Jobs;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::mutex failureLock;
+    std::exception_ptr failure;
+
+    const Job * Take(const size_t worker) {
+        {
+            auto & own = *queues[worker];
+            std::lock_guard<std::mutex> lock(own.Lock);
+            if (!own.Jobs.empty()) {
+                const auto job = own.Jobs.back();
+                own.Jobs.pop_back();
+                return job;
+            }
+        }
+        for (size_t i = 1; i < queues.size(); ++i) {
+            auto & victim = *queues[(worker + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(victim.Lock);
+            if (!victim.Jobs.empty()) {
+                const auto job = victim.Jobs.front();
+                victim.Jobs.pop_front();
+                return job;
+            }
+        }
+        return nullptr;
+    }
+
+    void Work(const size_t worker) {
+        while (const auto job = Take(worker)) {
+            try {
+                (*job)();
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(failureLock);
+                if (!failure) failure = std::current_exception();
+            }
+        }
+    }
+};
+
+#endif /* THREAD_POOL_H_ */
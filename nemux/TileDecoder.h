@@ -0,0 +1,88 @@
+/*
+ * TileDecoder.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: scorder
+ */
+
+#ifndef TILE_DECODER_H_
+#define TILE_DECODER_H_
+
+#include "Types.h"
+
+#include <cstdint>
+
+// The build target picks the decoder: AVX2 when enabled (-mavx2,
+// /arch:AVX2), SSE2 on every x86-64 and x86 with SSE2, portable otherwise
+#if defined(__AVX2__)
+#define TILE_DECODER_AVX2
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define TILE_DECODER_SSE2
+#include <emmintrin.h>
+#endif
+
+// Rows of 8 pixels of 2bpp tiles to palette indices
+// The pattern planes give bits 0 and 1 of each pixel and the attribute
+// planes bits 2 and 3, bit 7 of every plane is the leftmost pixel
+namespace tile {
+    static constexpr size_t WIDTH = 8;
+
+    // One byte per bit of b, the bit of byte i is bit 7 - i of b: b is
+    // copied to every byte, each byte keeps its own bit and the add carries
+    // it to bit 7
+    inline uint64_t Spread(const Byte b) {
+        const uint64_t bits = (b * 0x0101010101010101ULL) & 0x0102040810204080ULL;
+        return ((bits + 0x7F7F7F7F7F7F7F7FULL) >> 7) & 0x0101010101010101ULL;
+    }
+
+    inline void DecodeScalar(const Byte lo, const Byte hi, const Byte atLo, const Byte atHi, Byte * out) {
+        const uint64_t row = Spread(lo) | (Spread(hi) << 1) | (Spread(atLo) << 2) | (Spread(atHi) << 3);
+        for (size_t i = 0; i < WIDTH; ++i) out[i] = Byte(row >> (8 * i));
+    }
+
+#if defined(TILE_DECODER_SSE2)
+    // Each plane copied to the 8 bytes of a lane, compared with the bit of
+    // each byte and masked with the weight of the plane
+    inline void DecodeSse2(const Byte lo, const Byte hi, const Byte atLo, const Byte atHi, Byte * out) {
+        static constexpr uint64_t COPY = 0x0101010101010101ULL;
+        const __m128i bits = _mm_set1_epi64x(0x0102040810204080LL);
+        __m128i pattern = _mm_set_epi64x(int64_t(hi * COPY), int64_t(lo * COPY));
+        __m128i attribute = _mm_set_epi64x(int64_t(atHi * COPY), int64_t(atLo * COPY));
+        pattern = _mm_cmpeq_epi8(_mm_and_si128(pattern, bits), bits);
+        attribute = _mm_cmpeq_epi8(_mm_and_si128(attribute, bits), bits);
+        pattern = _mm_and_si128(pattern, _mm_set_epi64x(int64_t(2 * COPY), int64_t(COPY)));
+        attribute = _mm_and_si128(attribute, _mm_set_epi64x(int64_t(8 * COPY), int64_t(4 * COPY)));
+        __m128i row = _mm_or_si128(pattern, attribute);
+        row = _mm_or_si128(row, _mm_srli_si128(row, 8));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(out), row);
+    }
+#endif
+
+#if defined(TILE_DECODER_AVX2)
+    // The four planes in the lanes of one register
+    inline void DecodeAvx2(const Byte lo, const Byte hi, const Byte atLo, const Byte atHi, Byte * out) {
+        static constexpr uint64_t COPY = 0x0101010101010101ULL;
+        const __m256i bits = _mm256_set1_epi64x(0x0102040810204080LL);
+        __m256i planes = _mm256_set_epi64x(int64_t(atHi * COPY), int64_t(atLo * COPY), int64_t(hi * COPY), int64_t(lo * COPY));
+        planes = _mm256_cmpeq_epi8(_mm256_and_si256(planes, bits), bits);
+        planes = _mm256_and_si256(planes, _mm256_set_epi64x(int64_t(8 * COPY), int64_t(4 * COPY), int64_t(2 * COPY), int64_t(COPY)));
+        __m128i row = _mm_or_si128(_mm256_castsi256_si128(planes), _mm256_extracti128_si256(planes, 1));
+        row = _mm_or_si128(row, _mm_srli_si128(row, 8));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(out), row);
+    }
+#endif
+
+    inline void Decode(const Byte lo, const Byte hi, const Byte atLo, const Byte atHi, Byte * out) {
+#if defined(TILE_DECODER_AVX2)
+        DecodeAvx2(lo, hi, atLo, atHi, out);
+#elif defined(TILE_DECODER_SSE2)
+        DecodeSse2(lo, hi, atLo, atHi, out);
+#else
+        DecodeScalar(lo, hi, atLo, atHi, out);
+#endif
+    }
+}
+
+#endif /* TILE_DECODER_H_ */
@@ -3,6 +3,7 @@
 
 #include "Types.h"
 #include "BitUtil.h"
+#include "State.h"
 
 struct VRC6_Audio {
 
@@ -37,6 +38,11 @@ struct VRC6_Audio {
         int Phase = 0;
         Word Period = 0;
         Word T = 0;
+
+        template <class State_t>
+        void Serialize(State_t & state) {
+            state(Volume, IgnoreDuty, Enabled, Duty, Phase, Period, T);
+        }
         
         void WriteControl(const Byte value) {
             Volume = value & 0xF;
@@ -82,6 +88,11 @@ struct VRC6_Audio {
         Word T = 0;
         bool Enabled = false;
 
+        template <class State_t>
+        void Serialize(State_t & state) {
+            state(Accumulator, Rate, Step, Period, T, Enabled);
+        }
+
         void WriteControl(const Byte value) {
             Rate = value & 0x3F;
         }
@@ -127,6 +138,14 @@ struct VRC6_Audio {
     };
     
     SawChannel Saw;
+
+    template <class State_t>
+    void Serialize(State_t & state) {
+        state(Halted, Scale);
+        Pulse1.Serialize(state);
+        Pulse2.Serialize(state);
+        Saw.Serialize(state);
+    }
 };
 
 #endif /* VRC6_AUDIO_H_ */